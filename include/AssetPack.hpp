@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "Texture.hpp"
+
+/// Read-only, memory-mapped bundle of pre-decoded assets.
+///
+/// A pack holds images as raw RGBA rows and Ink scripts as source text, each
+/// under the name it was built with. Textures are uploaded straight from the
+/// mapped pixels, so loading one costs a single GPU upload and no decode or
+/// intermediate copy. Repeated `getTexture` calls for a name share one SDL
+/// texture while it is alive.
+///
+/// Layout (little-endian): a header, then an index of fixed-size entries,
+/// then the entry names, then the payloads, each aligned to 64 bytes.
+class AssetPack
+{
+public:
+    explicit AssetPack(const std::string &path);
+    ~AssetPack();
+
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    /// Write a pack containing `files` to `outPath`. PNGs are decoded to
+    /// RGBA, .ink files are stored as text. Entries are named by their path
+    /// relative to `root` (or as given when `root` is empty), with '/'
+    /// separators.
+    static void build(const std::string &outPath, const std::vector<std::string> &files,
+                      const std::string &root = "");
+
+    bool contains(const std::string &name) const { return m_entries.count(name) != 0; }
+    std::vector<std::string> getNames() const;
+
+    Texture getTexture(const std::string &name);
+
+    /// RGBA32 pixels of a texture entry, straight from the mapping and
+    /// valid while the pack is alive.
+    struct Image
+    {
+        const uint8_t *pixels;
+        int width;
+        int height;
+        int pitch;
+    };
+    Image getImage(const std::string &name) const;
+    std::string getScript(const std::string &name) const;
+
+    size_t size() const { return m_size; }
+
+    enum class EntryType : uint32_t
+    {
+        TEXTURE = 1,
+        SCRIPT = 2
+    };
+
+private:
+    struct Entry
+    {
+        EntryType type;
+        uint32_t width;
+        uint32_t height;
+        uint32_t pitch;
+        const uint8_t *data;
+        uint64_t size;
+    };
+
+    const Entry &find(const std::string &name, EntryType type) const;
+
+    // The mapped file; the file handle is closed once the view exists
+    const uint8_t *m_data{nullptr};
+    size_t m_size{0};
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::unordered_map<std::string, std::weak_ptr<SDL_Texture>> m_textures;
+};
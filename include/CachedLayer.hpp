@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Camera.hpp"
+#include "Texture.hpp"
+#include "Transform.hpp"
+
+class InkSprites;
+
+/// Offscreen texture for content that rarely changes.
+///
+/// Draws made between `begin()` and `end()` go into the layer's texture
+/// instead of the window, in layer pixel coordinates with the default
+/// camera. Drawing the layer afterwards is a single quad, however many
+/// sprites it holds, so a static background or HUD panel only costs its full
+/// draw when it is re-recorded:
+///
+///     if (layer.isDirty()) { layer.begin(); ...draws...; layer.end(); }
+///     layer.draw(transform);
+///
+/// A layer starts dirty, `end()` makes it clean, and `markDirty()` or a GPU
+/// reset that drops render target contents makes it dirty again.
+class CachedLayer
+{
+public:
+    CachedLayer(int width, int height);
+
+    CachedLayer(const CachedLayer &) = delete;
+    CachedLayer &operator=(const CachedLayer &) = delete;
+
+    /// Redirect drawing into the layer and clear it to transparent.
+    void begin();
+
+    /// Restore the previous target and camera, and mark the layer clean.
+    void end();
+
+    bool isRecording() const { return m_recording; }
+
+    bool isDirty() const;
+    void markDirty() { m_dirty = true; }
+
+    /// Re-record the layer as `sprites.render(anchor, pivot)` if it is dirty
+    /// or the sprites were added, removed or updated since it was last
+    /// recorded. Returns true if it re-recorded. Writes to sprite columns
+    /// from Python are not seen; call markDirty() after those.
+    bool update(InkSprites &sprites, const Vec2 &anchor = {}, const Vec2 &pivot = {});
+
+    /// Queue the layer like any sprite; anchor and pivot default to the
+    /// top-left corner.
+    void draw(const Transform &transform = {}, const Vec2 &anchor = {}, const Vec2 &pivot = {}, int layer = 0);
+
+    /// The layer's texture. Its colors are premultiplied by alpha, so its
+    /// blend mode starts as PREMULTIPLIED.
+    Texture &getTexture() { return m_texture; }
+
+    int getWidth() const { return m_texture.getWidth(); }
+    int getHeight() const { return m_texture.getHeight(); }
+
+private:
+    Texture m_texture;
+    bool m_dirty{true};
+    bool m_recording{false};
+    uint64_t m_generation{0};
+
+    // What the last update() recorded
+    const InkSprites *m_source{nullptr};
+    uint64_t m_sourceVersion{0};
+
+    // State replaced during recording
+    SDL_Texture *m_previousTarget{nullptr};
+    Camera m_previousCamera;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Vec2.hpp"
+
+/// 2D view: scrolls, zooms and rotates everything the renderer draws.
+///
+/// `pos` is the world position shown at the top-left of the view when zoom
+/// is 1 and rotation 0, so the default camera maps world to render
+/// coordinates unchanged. Zoom and rotation (radians) pivot around the
+/// center of the view.
+struct Camera
+{
+    Vec2 pos;
+    double zoom{1.0};
+    double rot{0.0};
+};
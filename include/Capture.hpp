@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <SDL3/SDL.h>
+
+/// Frame capture for screenshots, regression images and clips.
+///
+/// While capturing, the window is drawn through two offscreen targets in
+/// turn and copied to the window in `present()`. A frame is not read back at
+/// its present but when its target is about to be reused: at the first draw
+/// or clear two frames later, before any of that frame's commands reach SDL.
+/// By then its commands have long been submitted, so the readback usually
+/// finds the GPU done instead of stalling on the frame in progress. Frames
+/// left when the capture stops are read back right away, which does wait.
+/// Frames are converted and written on a background thread; the queue
+/// between the two is bounded, and a full queue either drops the new frame
+/// or blocks the render thread until there is room.
+namespace capture
+{
+    enum class Format : uint8_t
+    {
+        RAW, // RGBA32 rows of every frame, back to back, in one file
+        PNG, // one file per frame: "clip.png" becomes clip_000000.png, ...
+        Y4M  // YUV4MPEG2 (4:4:4) stream, readable by ffmpeg and most players
+    };
+
+    enum class QueuePolicy : uint8_t
+    {
+        DROP,
+        BLOCK
+    };
+
+    /// Capture up to `frameLimit` frames (0 for no limit) to `path`,
+    /// starting with the frame begun by the next present(). A PNG capture
+    /// limited to one frame writes `path` as is. `fps` only goes into the
+    /// Y4M header.
+    void start(const std::string &path, Format format = Format::PNG, size_t frameLimit = 0,
+               size_t queueSize = 8, QueuePolicy policy = QueuePolicy::DROP, int fps = 60);
+
+    /// Capture one frame to a PNG, the one after the next present().
+    void screenshot(const std::string &path);
+
+    /// Stop after the current frame. Queued frames are still written.
+    void stop();
+
+    /// True from start() until the last frame has been read back.
+    bool isActive();
+
+    /// Block until every queued frame has been written.
+    void wait();
+
+    struct Stats
+    {
+        uint64_t captured{0}; // frames read back
+        uint64_t written{0};
+        uint64_t dropped{0}; // frames the full queue turned away
+        uint64_t failed{0};  // frames that could not be converted or written
+        uint64_t queued{0};
+        uint64_t bytesWritten{0};
+        double writtenPerSecond{0.0}; // since start()
+        double renderMs{0.0};         // render-thread time per captured frame, blocking included
+        double encodeMs{0.0};         // background time per written frame
+        std::string error;            // latest conversion or write error, if any
+    };
+
+    /// Counters of the current or last capture.
+    Stats getStats();
+
+    /// The target the window is drawn into while capturing, else null.
+    SDL_Texture *_target();
+
+    /// Called by the renderer before it draws or clears: reads back the
+    /// frame held by _target() before it is overwritten.
+    void _begin();
+
+    /// Called by present() while active. `drawn` says whether the frame
+    /// went into _target(); leaves the window as the SDL render target.
+    void _present(bool drawn);
+
+    void _quit();
+}
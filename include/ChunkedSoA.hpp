@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+/// Paged Struct-of-Arrays storage of doubles.
+///
+/// Elements live in fixed-size, cache-line aligned blocks of `BLOCK_SIZE`
+/// entries. Every block holds all columns back to back, so a column pointer
+/// into a block stays valid while the container grows — growth appends blocks
+/// instead of reallocating and copying. Only `addColumns` moves blocks.
+/// Blocks emptied by `shrink` are kept in a small free pool and reused by the
+/// next `grow`.
+///
+/// Block layout: column `c` of a block starts at `base + c * BLOCK_SIZE`.
+class ChunkedSoA
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 1024;
+    static constexpr size_t ALIGNMENT = 64;
+    static constexpr size_t MAX_POOLED_BLOCKS = 32;
+
+    explicit ChunkedSoA(size_t columns);
+    ~ChunkedSoA();
+
+    ChunkedSoA(const ChunkedSoA &) = delete;
+    ChunkedSoA &operator=(const ChunkedSoA &) = delete;
+
+    size_t size() const { return m_size; }
+    size_t columns() const { return m_columns; }
+
+    /// Number of blocks holding at least one element.
+    size_t blockCount() const { return (m_size + BLOCK_SIZE - 1) / BLOCK_SIZE; }
+
+    /// Number of elements stored in `block` (only the last one can be partial).
+    size_t blockSize(size_t block) const;
+
+    double *column(size_t block, size_t col) { return m_blocks[block] + col * BLOCK_SIZE; }
+    const double *column(size_t block, size_t col) const { return m_blocks[block] + col * BLOCK_SIZE; }
+
+    double &at(size_t col, size_t index) { return column(index / BLOCK_SIZE, col)[index % BLOCK_SIZE]; }
+    double at(size_t col, size_t index) const { return column(index / BLOCK_SIZE, col)[index % BLOCK_SIZE]; }
+
+    /// Append `count` uninitialized elements.
+    void grow(size_t count);
+
+    /// Drop `count` elements from the end, returning emptied blocks to the pool.
+    void shrink(size_t count);
+
+    /// Copy every column of element `src` over element `dst`.
+    void copyElement(size_t dst, size_t src);
+
+    /// Append `count` columns, with `value` for every existing element, and
+    /// return the index of the first. Existing blocks are reallocated, so
+    /// this invalidates column pointers — meant for one-off opt-in fields,
+    /// not per-frame use.
+    size_t addColumns(size_t count, double value = 0.0);
+
+    /// Release pooled blocks back to the allocator.
+    void releasePool();
+
+private:
+    size_t blockBytes() const { return m_columns * BLOCK_SIZE * sizeof(double); }
+    double *allocBlock(size_t bytes);
+    void freeBlock(double *block);
+
+    std::vector<double *> m_blocks;
+    std::vector<double *> m_pool;
+    size_t m_columns;
+    size_t m_size{0};
+};
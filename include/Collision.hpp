@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Vec2.hpp"
+#include "Rect.hpp"
+
+class InkSprites;
+
+/// Native broadphase collision for InkSprites groups.
+///
+/// Sprites are tested as axis-aligned boxes: the texture clip rect scaled by
+/// |scale| and offset by `anchor`, ignoring rotation (the same box Ink scripts
+/// use for bounds checks). One side is bucketed into a SpatialGrid keyed on box
+/// corners; the other side is queried against it in parallel, one result list
+/// per block, so the output order is deterministic.
+///
+/// Results are flattened pairs: [a0, b0, a1, b1, ...]. With `flagHits` set,
+/// every sprite involved in a pair gets its `hit` field set to 1.
+namespace collision
+{
+    /// Overlapping (index in a, index in b) pairs. When `a` and `b` are the
+    /// same group, each unordered pair is reported once with a < b.
+    std::vector<uint32_t> spritePairs(
+        InkSprites &a, InkSprites &b,
+        const Vec2 &anchorA = {}, const Vec2 &anchorB = {},
+        bool flagHits = false);
+
+    /// Overlapping (sprite index, rect index) pairs against static geometry.
+    std::vector<uint32_t> rectPairs(
+        InkSprites &sprites, const std::vector<Rect> &rects,
+        const Vec2 &anchor = {}, bool flagHits = false);
+}
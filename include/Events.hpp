@@ -49,6 +49,25 @@ namespace events
     // Poll events and return them (can be called from Python)
     std::vector<Event> pollEvents();
 
+    // Flat form of any event, with the fields that don't apply left at 0
+    struct EventRecord
+    {
+        int32_t type; // an EventType
+        float x;
+        float y;
+        int32_t key;
+        int32_t button;
+    };
+
+    // Poll events into a buffer that is reused from poll to poll, so steady
+    // polling doesn't allocate. Valid until the next poll.
+    const std::vector<EventRecord> &pollRecords();
+
+    // Merge runs of consecutive mouse motion into their last position, for
+    // high-rate mice. Off by default.
+    void setMotionCoalescing(bool enabled);
+    bool getMotionCoalescing();
+
     // Check if quit was requested
     bool shouldQuit();
 }
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cmath>
+
+namespace fastmath
+{
+    /// Branch-free single-precision sin and cos, written so loops calling it
+    /// auto-vectorize. Cody-Waite reduction to [-pi/4, pi/4] followed by the
+    /// Cephes minimax polynomials; absolute error stays below 1e-6 for
+    /// |x| < 8192, which covers any sane sprite rotation.
+    inline void sincos(float x, float &s, float &c)
+    {
+        constexpr float TWO_OVER_PI = 0.636619772367581343f;
+        constexpr float PIO2_1 = 1.5703125f;
+        constexpr float PIO2_2 = 4.837512969970703125e-4f;
+        constexpr float PIO2_3 = 7.54978995489188216e-8f;
+
+        // Nearest quadrant; truncation after adding +-0.5 keeps this to
+        // instructions every SIMD target has.
+        int q = static_cast<int>(x * TWO_OVER_PI + std::copysign(0.5f, x));
+        float qf = static_cast<float>(q);
+        float r = ((x - qf * PIO2_1) - qf * PIO2_2) - qf * PIO2_3;
+        float r2 = r * r;
+
+        float ps = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        float pc = 1.0f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+        // Quadrant fix-up: odd quadrants swap sin/cos, bit 1 flips signs
+        bool swap = (q & 1) != 0;
+        float sv = swap ? pc : ps;
+        float cv = swap ? ps : pc;
+        s = (q & 2) ? -sv : sv;
+        c = ((q + 1) & 2) ? -cv : cv;
+    }
+}
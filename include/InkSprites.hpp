@@ -1,21 +1,29 @@
 #pragma once
 
-#include <vector>
 #include <random>
 #include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <memory>
 
+#include "ChunkedSoA.hpp"
+#include "Color.hpp"
+#include "Renderer.hpp"
+#include "SpatialGrid.hpp"
 #include "Vec2.hpp"
 #include "Rect.hpp"
 #include "ink/AST.hpp"
+#include "ink/Analysis.hpp"
 #include "ink/Interpreter.hpp"
 
 class Texture;
 
 /// A batch of sprites whose behavior is defined by an Ink script.
 ///
-/// Uses Struct-of-Arrays storage for maximum throughput. The Ink interpreter
-/// executes vectorized operations over all sprites each frame — no per-sprite
-/// Python callbacks needed.
+/// Uses paged Struct-of-Arrays storage (see ChunkedSoA) for maximum throughput.
+/// The Ink interpreter executes vectorized operations block by block each
+/// frame — no per-sprite Python callbacks needed.
 ///
 /// Built-in mutable fields (accessible in .ink scripts):
 ///   pos.x, pos.y      — position
@@ -28,38 +36,269 @@ class Texture;
 /// Built-in read-only constants:
 ///   dt             — delta time (set each frame)
 ///   bounds.x/y/w/h — viewport bounds
-///   rect_w, rect_h — scaled sprite dimensions
 ///   PI             — 3.14159...
+///
+/// Derived read-only fields (per sprite, only allocated when the script reads
+/// them, cached between frames and recomputed only for blocks whose scale
+/// changed — by add/remove, or by a script assignment to scale.*, in which
+/// case the next read in the same update already sees the new scale):
+///   rect_w, rect_h — texture clip size scaled by scale.x / scale.y
+///
+/// Assigning to a read-only field is an error.
+///
+/// Read-only neighbor fields (need enableSpatialIndex; computed only when the
+/// script reads them, over sprites within the neighbor radius, self excluded):
+///   neighbors.count                        — number of neighbors
+///   neighbors.dir_x, neighbors.dir_y       — mean of the neighbors' dir
+///   neighbors.center_x, neighbors.center_y — mean neighbor position (own
+///                                            position when there are none)
+///
+/// Opt-in fields (allocated when the script uses them):
+///   hit            — set to 1 by collide(..., flag_hits=True); scripts clear it
+///                    (also allocated when collisions flag hits)
+///   color.r/g/b/a  — per-sprite tint and alpha in [0, 1], default 1; they
+///                    multiply the texture's alpha in the vertex colors
+///   frame          — index into the texture's frames (Texture::setFrameGrid),
+///                    default 0; floor(frame) is drawn, wrapped into range
+///
+/// update() runs the behavior on the job pool, each worker taking a run of
+/// blocks with its own interpreter. In fused mode (setFused) the worker also
+/// culls each block and emits its visible quads right after running the
+/// behavior on it, while the block is still in cache, and render() submits
+/// them without touching the SoA again. The vertices are rebuilt by render()
+/// if sprites were added/removed, or the texture state, anchor/pivot, camera,
+/// view size or culling setting changed since the update.
+///
+/// Every sprite gets a persistent generational handle from `add`. Handles stay
+/// valid while sprites around them are removed and go stale (never alias a
+/// newer sprite) once their own sprite is removed. Removal by handle is a
+/// swap-remove, so the SoA stays dense and sprite indices are not stable.
 class InkSprites
 {
 public:
+    /// Generation in the high 32 bits, handle slot in the low 32 bits.
+    using Handle = uint64_t;
+
+    /// Ink source text, for scripts that don't come from a file.
+    struct Script
+    {
+        std::string source;
+    };
+
     InkSprites(Texture *texture, const Rect &bounds, const std::string &scriptPath);
+    InkSprites(Texture *texture, const Rect &bounds, const Script &script);
+    ~InkSprites();
 
-    void add(int count, double scale = 1.0);
+    std::vector<Handle> add(int count, double scale = 1.0);
     void remove(int count = 1);
-    size_t count() const { return m_size; }
+    size_t count() const { return m_data.size(); }
+
+    bool removeHandle(Handle handle);
+    size_t removeHandles(const Handle *handles, size_t count);
+
+    bool isAlive(Handle handle) const { return indexOf(handle) >= 0; }
+
+    /// Current dense index of the sprite, or -1 if the handle is stale.
+    int64_t indexOf(Handle handle) const;
+    Handle handleAt(size_t index) const;
+
+    /// Build a uniform grid over sprite positions every frame.
+    /// `neighborRadius` is used by the neighbors.* fields (0 = cellSize).
+    void enableSpatialIndex(double cellSize, double neighborRadius = 0.0);
+    void disableSpatialIndex();
+
+    /// Indices of sprites within `radius` of `center` / inside `rect`.
+    std::vector<uint32_t> queryRadius(const Vec2 &center, double radius);
+    std::vector<uint32_t> queryRect(const Rect &rect);
+
+    /// Allocate the `hit` column if needed and set it to 1 for sprite `index`.
+    void markHit(size_t index);
+
+    /// The enable*Field calls allocate an opt-in column, at its default for
+    /// existing sprites. This reallocates every block, so pointers from
+    /// data().column() taken before are invalid afterwards.
+    void enableHitField();
+
+    /// Allocate the color.r/g/b/a columns if needed, at 1 for every sprite.
+    void enableColorField();
+
+    /// Allocate the `frame` column if needed. Each sprite draws frame
+    /// floor(frame) of the texture's frame table (see Texture::setFrameGrid),
+    /// wrapped into range.
+    void enableFrameField();
+
+    const ChunkedSoA &data() const { return m_data; }
+    Texture *getTexture() const { return m_texture; }
 
     void update(double dt);
+
+    /// Bumped by update() and whenever sprites are added or removed.
+    uint64_t getVersion() const { return m_version; }
+
     void render(const Vec2 &anchor = {}, const Vec2 &pivot = {});
 
+    /// Build render vertices during update() using `anchor` and `pivot`.
+    void setFused(bool enabled, const Vec2 &anchor = {}, const Vec2 &pivot = {});
+    bool isFused() const { return m_fused; }
+
+    /// How render() draws the group. POINTS draws each sprite as an
+    /// untextured dot at its center; DENSITY counts sprites per screen cell
+    /// and draws the counts as one texture, for counts where individual
+    /// sprites are no longer visible.
+    enum class RenderMode : uint8_t
+    {
+        SPRITES,
+        POINTS,
+        DENSITY
+    };
+
+    void setRenderMode(RenderMode mode) { m_renderMode = mode; }
+    RenderMode getRenderMode() const { return m_renderMode; }
+
+    /// In SPRITES mode, draw points instead while the texture's clip area is
+    /// smaller than `pixels` on screen at the camera's zoom (sprite scale is
+    /// not considered). 0 disables.
+    void setLodThreshold(double pixels) { m_lodThreshold = pixels; }
+    double getLodThreshold() const { return m_lodThreshold; }
+
+    /// Side of a point in pixels. Points of size 1 without color.* fields
+    /// go through SDL_RenderPoints, others are drawn as small quads.
+    void setPointSize(double pixels);
+    double getPointSize() const { return m_pointSize; }
+
+    /// Color of points and of the densest density cells; multiplied by the
+    /// texture's alpha and any color.* fields.
+    void setPointColor(const Color &color) { m_pointColor = color; }
+    Color getPointColor() const { return m_pointColor; }
+
+    /// Side in pixels of a density cell.
+    void setDensityCellSize(int pixels);
+    int getDensityCellSize() const { return m_densityCellSize; }
+
+    /// Column layout of the SoA storage.
+    enum Field : size_t
+    {
+        POS_X,
+        POS_Y,
+        DIR_X,
+        DIR_Y,
+        ROT,
+        SCALE_X,
+        SCALE_Y,
+        SPEED,
+        ANGLE_SPEED,
+        FIELD_COUNT
+    };
+
+    static constexpr size_t NO_COLUMN = SIZE_MAX;
+
 private:
-    void rebindFields();
+    // Columns following m_colNeighbors, in order
+    enum NeighborField : size_t
+    {
+        NEIGHBOR_COUNT,
+        NEIGHBOR_DIR_X,
+        NEIGHBOR_DIR_Y,
+        NEIGHBOR_CENTER_X,
+        NEIGHBOR_CENTER_Y,
+        NEIGHBOR_FIELD_COUNT
+    };
+
+    void bindBlock(ink::Interpreter &interpreter, size_t block);
+    void renderPoints(const Vec2 &anchor);
+    void renderDensity(const Vec2 &anchor);
+    void buildBlockQuads(size_t block, const renderer::QuadParams &params,
+                         const renderer::FrameTable &frames, SDL_Vertex *out) const;
+    void buildVisibleQuads(size_t block, const renderer::QuadParams &params,
+                           const renderer::FrameTable &frames, size_t visible, SDL_Vertex *out) const;
+    void markRectsDirty(size_t first, size_t last);
+    void refreshRects(size_t block, const Rect &clip);
+    void refreshSpatialIndex();
+    void computeNeighbors();
+    Handle acquireHandle(uint32_t index);
+    void releaseHandle(uint32_t slot);
+    void swapRemove(size_t index);
+
+    // SoA storage, one column per Field plus opt-in columns
+    ChunkedSoA m_data{FIELD_COUNT};
+    size_t m_colNeighbors{NO_COLUMN};
+    size_t m_colHit{NO_COLUMN};
+    size_t m_colRect{NO_COLUMN};  // rect_w, rect_h
+    size_t m_colColor{NO_COLUMN}; // color.r, color.g, color.b, color.a
+    size_t m_colFrame{NO_COLUMN};
 
-    // SoA arrays
-    std::vector<double> m_pos_x, m_pos_y;
-    std::vector<double> m_dir_x, m_dir_y;
-    std::vector<double> m_rot;
-    std::vector<double> m_scale_x, m_scale_y;
-    std::vector<double> m_speed;
-    std::vector<double> m_angle_speed;
+    // Per-block dirty flags for the rect_w/rect_h cache
+    std::vector<uint8_t> m_rectDirty;
+    double m_rectClipW{0.0};
+    double m_rectClipH{0.0};
+
+    // Values written into opt-in columns for newly added sprites
+    std::vector<std::pair<size_t, double>> m_columnDefaults;
+
+    // Ink name -> column, rebound for every block
+    std::vector<std::pair<std::string, size_t>> m_bindings;
+    std::vector<std::pair<std::string, size_t>> m_readOnlyBindings;
+
+    // Sparse set: handle slot -> dense index, dense index -> handle slot
+    std::vector<uint32_t> m_sparse;
+    std::vector<uint32_t> m_generation;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<uint32_t> m_dense;
 
-    size_t m_size{0};
     Texture *m_texture;
     Rect m_bounds;
 
+    // Spatial index, rebuilt lazily after sprites move
+    SpatialGrid m_grid;
+    double m_neighborRadius{0.0};
+    bool m_gridStale{true};
+
     // Ink scripting
     ink::BehaviorDecl m_behavior;
-    ink::Interpreter m_interpreter;
+    ink::FieldUsage m_usage;
+    std::vector<ink::Interpreter> m_interpreters; // one per update() partition
+
+    // Reused quad buffer and frame table for render()
+    std::vector<SDL_Vertex> m_vertices;
+    renderer::FrameTable m_frames;
+
+    // Culling: on-screen sprite indices, BLOCK_SIZE slots per block, and
+    // each block's offset into the packed quads (total at the end)
+    std::vector<uint32_t> m_visible;
+    std::vector<size_t> m_visibleOffsets;
+    std::vector<SDL_Vertex> m_culledVertices;
+
+    // Fused update-and-emit state; m_fusedValid means m_vertices matches the
+    // SoA as of the last update()
+    bool m_fused{false};
+    bool m_fusedValid{false};
+    Vec2 m_fusedAnchor;
+    Vec2 m_fusedPivot;
+    renderer::QuadParams m_fusedParams;
+    renderer::FrameTable m_fusedFrames;
+    bool m_fusedCulled{false};
+    Vec2 m_fusedViewSize;
+    std::vector<size_t> m_fusedVisible; // visible quads per block, packed at the block's slot
+
+    uint64_t m_version{0};
+
+    // LOD rendering
+    RenderMode m_renderMode{RenderMode::SPRITES};
+    double m_lodThreshold{0.0};
+    double m_pointSize{1.0};
+    Color m_pointColor{255, 255, 255, 255};
+    std::vector<SDL_FPoint> m_points;
+
+    // Density mode: one bin grid per partition of the blocks, summed into
+    // the first; the texture is recreated when the grid size changes
+    int m_densityCellSize{2};
+    std::vector<uint32_t> m_densityBins;
+    std::vector<uint32_t> m_densityRowMax;
+    std::vector<size_t> m_densityInside; // sprites binned, per partition
+    std::vector<uint32_t> m_densityPixels;
+    std::unique_ptr<Texture> m_densityTexture;
+    int m_densityW{0};
+    int m_densityH{0};
 
     std::mt19937 m_rng{std::random_device{}()};
 };
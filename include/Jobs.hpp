@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+/// Shared worker pool for data-parallel passes.
+///
+/// Workers start lazily on first use (one per hardware thread, minus the
+/// caller). `parallelFor` always lets the calling thread take part, so it is
+/// safe to call from any thread and degrades to a plain loop on single-core
+/// machines.
+namespace jobs
+{
+    /// Type-erased parallelFor: calls `fn(context, begin, end)`.
+    void _parallelFor(size_t count, size_t grain, void (*fn)(void *, size_t, size_t), void *context);
+
+    /// Split [0, count) into contiguous ranges of about `grain` elements and
+    /// run `fn(begin, end)` on each. Blocks until every range has finished.
+    ///
+    /// `fn` is called through a reference, never copied, and the pool keeps
+    /// no per-call state on the heap, so a steady stream of calls does not
+    /// allocate. If `fn` throws, the ranges not yet started are skipped and
+    /// the first exception is rethrown once every thread has left `fn`.
+    template <typename F>
+    void parallelFor(size_t count, size_t grain, F &&fn)
+    {
+        using Fn = std::remove_reference_t<F>;
+        _parallelFor(
+            count, grain, [](void *context, size_t begin, size_t end)
+            { (*static_cast<Fn *>(context))(begin, end); },
+            const_cast<void *>(static_cast<const void *>(std::addressof(fn))));
+    }
+
+    /// Queue a fire-and-forget task on the pool.
+    void submit(std::function<void()> task);
+
+    /// Number of threads that take part in a parallelFor (workers + caller).
+    size_t concurrency();
+
+    void _quit();
+}
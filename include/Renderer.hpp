@@ -1,6 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SDL3/SDL.h>
+
+#include "Camera.hpp"
+#include "Rect.hpp"
 #include "Vec2.hpp"
 #include "Color.hpp"
 
@@ -12,9 +19,78 @@ namespace renderer
     void clear(const Color &color = {0, 0, 0, 255});
     void present();
 
-    void draw(const Texture &texture, const Transform &transform, const Vec2 &anchor = {}, const Vec2 &pivot = {});
+    // Queue a sprite. Queued draws are sorted by layer, then texture and
+    // blend mode (draw order breaks ties), and submitted as merged geometry
+    // batches by flush(), which clear() and present() call. Batch draws
+    // below flush first and are drawn at the point they are called.
+    void draw(const Texture &texture, const Transform &transform, const Vec2 &anchor = {}, const Vec2 &pivot = {}, int layer = 0);
+    void flush();
+
+    // Strict order keeps draw order within a layer instead of grouping by
+    // texture, for scenes where overlapping sprites must stack as drawn
+    void set_strict_order(bool enabled);
+    bool get_strict_order();
+
+    // Camera applied to everything drawn after it is set. Draws already
+    // queued keep the camera they were made with, so switching to the
+    // default camera mid-frame draws a screen-space overlay.
+    void set_camera(const Camera &camera);
+    const Camera &get_camera();
+
+    // Size of the visible area (the render target, or the logical size when
+    // letterboxing), as cached by clear() and set_target()
+    Vec2 get_view_size();
+
+    // Map between world and render coordinates through the current camera
+    Vec2 world_to_screen(const Vec2 &point);
+    Vec2 screen_to_world(const Vec2 &point);
+
+    // Draw into `target`, a texture created with SDL_TEXTUREACCESS_TARGET,
+    // or the window when null. Queued draws are flushed to the old target
+    // first; culling and the camera center use the new target's size.
+    void set_target(SDL_Texture *target);
+    SDL_Texture *get_target();
+
+    // Bumped whenever the GPU may have dropped render target contents, so
+    // cached targets know to redraw
+    uint64_t target_generation();
 
-    // Batch render from SoA arrays (no Transform construction needed)
+    // What the renderer did during one presented frame. Counting is a few
+    // increments per SDL call, so it is always on.
+    struct FrameStats
+    {
+        uint64_t frame{0};          // presents before this frame
+        uint64_t drawCalls{0};      // geometry, texture and point submissions
+        uint64_t sprites{0};        // quads, sprites and points drawn
+        uint64_t culled{0};         // sprites skipped by culling
+        uint64_t vertices{0};       // geometry vertices and points submitted
+        uint64_t textureBinds{0};   // submissions with a different texture than the last
+        uint64_t targetSwitches{0}; // render target changes
+        // SDL state calls (texture blend and mods, draw color, render
+        // target) made and skipped as redundant. The renderer remembers
+        // what it last set, so only changes reach SDL.
+        uint64_t stateCalls{0};
+        uint64_t stateCallsSkipped{0};
+    };
+
+    // Stats of the last presented frame
+    FrameStats get_frame_stats();
+
+    // Stats of up to the last `set_stats_history` presented frames, oldest
+    // first. 120 frames by default.
+    std::vector<FrameStats> get_stats_history();
+    void set_stats_history(size_t frames);
+    size_t get_stats_history_size();
+
+    // Skip sprites whose bounding circle, which covers any rotation, lies
+    // outside the visible area. Applies to draw(), the batch draws and
+    // InkSprites. On by default.
+    void set_culling(bool enabled);
+    bool get_culling();
+
+    // Batch render from SoA arrays (no Transform construction needed).
+    // Builds quads in C++ and submits them through SDL_RenderGeometry,
+    // falling back to one SDL_RenderTextureRotated per sprite if that fails.
     void draw_batch_soa(
         const Texture &texture,
         const double *pos_x, const double *pos_y,
@@ -23,7 +99,161 @@ namespace renderer
         size_t count,
         const Vec2 &anchor = {}, const Vec2 &pivot = {});
 
-    void _init(SDL_Window *window, const int width, const int height);
+    // Same as draw_batch_soa but one SDL_RenderTextureRotated call per sprite
+    void draw_batch_soa_rotated(
+        const Texture &texture,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        const Vec2 &anchor = {}, const Vec2 &pivot = {});
+
+    // Per-batch quad inputs. Gathered from the texture and camera on the SDL
+    // thread so that build_quads itself touches no SDL state and can run on
+    // workers.
+    struct QuadParams
+    {
+        double clipW{0.0};
+        double clipH{0.0};
+        float u0{0.0f}, v0{0.0f}, u1{1.0f}, v1{1.0f};
+        SDL_FColor color{1.0f, 1.0f, 1.0f, 1.0f};
+        Vec2 anchor;
+        Vec2 pivot;
+
+        // Camera as an affine map from world to render coordinates:
+        // x' = viewCos * x + viewSin * y + viewX and
+        // y' = -viewSin * x + viewCos * y + viewY, where viewCos and viewSin
+        // carry the zoom. Sprites are also turned by -viewAngle and scaled
+        // by viewZoom.
+        double viewCos{1.0}, viewSin{0.0};
+        double viewX{0.0}, viewY{0.0};
+        double viewAngle{0.0};
+        double viewZoom{1.0};
+
+        bool operator==(const QuadParams &other) const
+        {
+            return clipW == other.clipW && clipH == other.clipH &&
+                   u0 == other.u0 && v0 == other.v0 && u1 == other.u1 && v1 == other.v1 &&
+                   color.r == other.color.r && color.g == other.color.g &&
+                   color.b == other.color.b && color.a == other.color.a &&
+                   anchor == other.anchor && pivot == other.pivot &&
+                   viewCos == other.viewCos && viewSin == other.viewSin &&
+                   viewX == other.viewX && viewY == other.viewY &&
+                   viewAngle == other.viewAngle && viewZoom == other.viewZoom;
+        }
+    };
+
+    QuadParams quad_params(const Texture &texture, const Vec2 &anchor, const Vec2 &pivot);
+
+    // Write the four rotated corners of each sprite into `out`
+    // (4 * count vertices, clockwise from the top-left corner).
+    // Thread-safe; output depends only on the inputs, not on how a batch is
+    // split between threads.
+    void build_quads(
+        const QuadParams &params,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        SDL_Vertex *out);
+
+    // UVs (flip applied) and sizes of a texture's frames, 4 and 2 values per
+    // frame. A texture without frames has one: its clip area.
+    struct FrameTable
+    {
+        std::vector<float> uv;
+        std::vector<double> size;
+
+        size_t count() const { return size.size() / 2; }
+
+        // Largest frame width and height, for conservative culling
+        Vec2 maxSize() const
+        {
+            Vec2 largest;
+            for (size_t k = 0; k < count(); k++)
+            {
+                largest.x = std::max(largest.x, size[k * 2]);
+                largest.y = std::max(largest.y, size[k * 2 + 1]);
+            }
+            return largest;
+        }
+        bool operator==(const FrameTable &other) const { return uv == other.uv && size == other.size; }
+    };
+
+    void frame_table(const Texture &texture, FrameTable &out);
+
+    // build_quads with each sprite's size and UVs taken from frame
+    // floor(frame[i]) of `frames`, wrapped into range. The lookup is a
+    // plain gather, so it adds no per-sprite branches.
+    void build_quads(
+        const QuadParams &params,
+        const FrameTable &frames,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        const double *frame,
+        size_t count,
+        SDL_Vertex *out);
+
+    // build_quads for the sprites listed in `indices`: quad k is built for
+    // sprite indices[k]. `frames` and `frame` may be null.
+    void build_quads_indexed(
+        const QuadParams &params,
+        const FrameTable *frames,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        const double *frame,
+        const uint32_t *indices,
+        size_t count,
+        SDL_Vertex *out);
+
+    // Write the indices of on-screen sprites to `out` (room for `count`) in
+    // order, and return how many there are. Sprites are tested by the
+    // bounding circle of a clipW x clipH quad around its rotation center
+    // against the visible area cached by clear(). When all of them are
+    // visible `out` is left untouched. Thread-safe.
+    size_t cull_sprites(
+        const QuadParams &params,
+        const double *pos_x, const double *pos_y,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        uint32_t *out);
+
+    // Multiply the vertex colors of `count` quads by per-sprite RGBA values,
+    // clamped to [0, 1]. Thread-safe, like build_quads.
+    void tint_quads(
+        const double *r, const double *g, const double *b, const double *a,
+        size_t count,
+        SDL_Vertex *out);
+
+    // Submit prebuilt quads in large SDL_RenderGeometry chunks. Returns the
+    // number of quads submitted; fewer than `quadCount` means the renderer
+    // rejected geometry and the caller should fall back for the rest.
+    size_t draw_quads(const Texture &texture, const SDL_Vertex *vertices, size_t quadCount);
+
+    // Submit untextured quads (vertex colors only), like draw_quads
+    size_t draw_colored_quads(const SDL_Vertex *vertices, size_t quadCount);
+
+    // One-pixel points in a single color, in render coordinates
+    void draw_points(const SDL_FPoint *points, size_t count, const SDL_FColor &color);
+
+    // Draw `texture` into `dst` in render coordinates, ignoring the camera,
+    // for overlays that are already in screen space
+    void draw_screen(const Texture &texture, const Rect &dst);
+
+    // The current render target as RGBA32 rows, `width` * 4 bytes each;
+    // with the window as target, the frame drawn so far, so call it before
+    // present(). Flushes and waits for the GPU (see Capture.hpp for reading
+    // frames back without stalling).
+    std::vector<uint8_t> read_pixels(int &width, int &height);
+
+    // Sprites dropped by culling outside the renderer, such as InkSprites
+    void _count_culled(size_t count);
+    void _targets_lost();
+    void _view_changed();
+    void _forget_texture(SDL_Texture *texture);
+    void _init(SDL_Window *window, const int width, const int height, bool software = false);
     void _quit();
     SDL_Renderer *_get();
 }
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "Rect.hpp"
+
+class ChunkedSoA;
+
+/// Uniform-grid spatial index over a set of 2D points.
+///
+/// `rebuild` buckets points with a counting sort: one pass assigns cells (run
+/// in parallel), one pass counts, a prefix sum turns counts into offsets and a
+/// final pass scatters indices and positions into cell order. All buffers are
+/// kept between rebuilds, so steady-state rebuilds do not allocate.
+///
+/// Points outside the configured bounds are clamped into the border cells, so
+/// queries stay correct for anything that wanders off the grid — just slower.
+/// NaN coordinates land in the first cell.
+class SpatialGrid
+{
+public:
+    static constexpr size_t MAX_CELLS = size_t{1} << 22;
+
+    void configure(const Rect &bounds, double cellSize);
+    bool isConfigured() const { return m_cellSize > 0.0; }
+    double getCellSize() const { return m_cellSize; }
+
+    /// Index the points stored in columns `colX`/`colY` of `data`. Columns in
+    /// `payload` are copied into cell order alongside the positions so that
+    /// neighbor loops read them sequentially instead of by random index.
+    void rebuild(const ChunkedSoA &data, size_t colX, size_t colY,
+                 const std::vector<size_t> &payload = {});
+
+    size_t size() const { return m_indices.size(); }
+
+    // Per-slot accessors for forEachCandidate callbacks
+    uint32_t indexAt(size_t slot) const { return m_indices[slot]; }
+    double xAt(size_t slot) const { return m_sortedX[slot]; }
+    double yAt(size_t slot) const { return m_sortedY[slot]; }
+    double payloadAt(size_t column, size_t slot) const { return m_payload[column][slot]; }
+
+    /// Indices of all points within `radius` of (x, y).
+    void queryRadius(double x, double y, double radius, std::vector<uint32_t> &out) const;
+
+    /// Indices of all points inside `rect`.
+    void queryRect(const Rect &rect, std::vector<uint32_t> &out) const;
+
+    /// Call `fn(slot)` for every point in the cells overlapping the box
+    /// [x0, x1] x [y0, y1]. Candidates are not distance-filtered.
+    template <typename Fn>
+    void forEachCandidate(double x0, double y0, double x1, double y1, Fn &&fn) const
+    {
+        if (m_indices.empty())
+            return;
+
+        int c0 = cellX(x0), c1 = cellX(x1);
+        int r0 = cellY(y0), r1 = cellY(y1);
+        for (int r = r0; r <= r1; r++)
+        {
+            // Cells of one row are contiguous in sorted order
+            size_t rowBase = static_cast<size_t>(r) * m_cols;
+            uint32_t begin = m_cellStart[rowBase + c0];
+            uint32_t end = m_cellStart[rowBase + c1 + 1];
+            for (size_t k = begin; k < end; k++)
+                fn(k);
+        }
+    }
+
+private:
+    // Written so NaN fails the first test; std::clamp would pass it through
+    // to the int conversion
+    static int clampCell(double c, int count)
+    {
+        if (!(c >= 0.0))
+            return 0;
+        if (c >= static_cast<double>(count - 1))
+            return count - 1;
+        return static_cast<int>(c);
+    }
+
+    int cellX(double x) const
+    {
+        return clampCell((x - m_bounds.x) * m_invCellSize, m_cols);
+    }
+
+    int cellY(double y) const
+    {
+        return clampCell((y - m_bounds.y) * m_invCellSize, m_rows);
+    }
+
+    Rect m_bounds;
+    double m_cellSize{0.0};
+    double m_invCellSize{0.0};
+    int m_cols{0};
+    int m_rows{0};
+
+    // Counting-sort buffers, reused across rebuilds
+    std::vector<uint32_t> m_cellOf;
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_cursor;
+    std::vector<uint32_t> m_indices;
+    std::vector<double> m_sortedX, m_sortedY;
+    std::vector<std::vector<double>> m_payload;
+};
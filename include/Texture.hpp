@@ -1,6 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <cstdint>
+#include <vector>
 
 #include <nanobind/nanobind.h>
 #include <SDL3/SDL.h>
@@ -9,6 +12,15 @@
 
 namespace nb = nanobind;
 
+/// An image that can be drawn, backed by a shared SDL texture.
+///
+/// A Texture either owns a whole SDL texture (loaded from a file) or is a
+/// region of one shared with other Textures, such as a sprite packed into a
+/// TextureAtlas page. Width, height and the clip area are always relative to
+/// the Texture's own region; getSourceRect maps the clip area into the SDL
+/// texture. Alpha and blend mode belong to the Texture, not the SDL texture,
+/// so regions sharing a page do not affect each other; they are applied when
+/// the Texture is drawn.
 class Texture
 {
 public:
@@ -18,8 +30,31 @@ public:
         bool v{false};
     } flip;
 
+    enum class BlendMode : uint8_t
+    {
+        NONE,
+        BLEND,
+        ADD,
+        MOD,
+        MUL,
+        // For textures whose colors already carry alpha, such as
+        // CachedLayer targets drawn with BLEND
+        PREMULTIPLIED
+    };
+
+    /// Load through the texture cache; repeated loads of a path share one
+    /// SDL texture.
     explicit Texture(const std::string &file_path);
-    ~Texture();
+
+    /// The whole of an existing SDL texture.
+    explicit Texture(std::shared_ptr<SDL_Texture> texture);
+
+    /// View `region` (in pixels) of an existing SDL texture.
+    Texture(std::shared_ptr<SDL_Texture> texture, const Rect &region);
+
+    /// Take ownership of `texture`, typically fresh from
+    /// SDL_CreateTextureFromSurface. Throws if it is null.
+    static std::shared_ptr<SDL_Texture> share(SDL_Texture *texture);
 
     int getWidth() const { return m_width; }
     int getHeight() const { return m_height; }
@@ -28,14 +63,66 @@ public:
     Rect getClipArea() const { return m_clipArea; }
     void setClipArea(const Rect &area) { m_clipArea = area; }
 
-    float getAlpha() const;
-    void setAlpha(float alpha) const;
+    /// The Texture's region of the underlying SDL texture, in pixels.
+    Rect getRegion() const { return m_region; }
+
+    /// Clip area in pixels of the underlying SDL texture.
+    Rect getSourceRect() const
+    {
+        return {m_clipArea.x + m_region.x, m_clipArea.y + m_region.y, m_clipArea.w, m_clipArea.h};
+    }
+
+    /// Split the texture into a grid of equal frames, numbered row by row
+    /// from the top-left. `count` keeps only the first frames of a partly
+    /// filled sheet (0 keeps all of them). The clip area becomes frame 0.
+    void setFrameGrid(int columns, int rows, int count = 0);
+
+    /// Use explicit frame regions (relative to the texture, like the clip
+    /// area), for sheets packed by an external tool. The clip area becomes
+    /// frame 0.
+    void setFrames(const std::vector<Rect> &frames);
 
-    SDL_Texture *getSDL() const { return m_texture; }
+    const std::vector<Rect> &getFrames() const { return m_frames; }
+    size_t getFrameCount() const { return m_frames.size(); }
+
+    /// Set the clip area to frame `index`, wrapping around the frame count.
+    void setFrame(size_t index);
+
+    float getAlpha() const { return m_alpha; }
+    void setAlpha(float alpha) { m_alpha = alpha; }
+
+    // Alpha as a vertex color. SDL_RenderGeometry ignores the texture's mod
+    // state, so batched geometry has to bake it in. Premultiplied colors
+    // fade with alpha too.
+    SDL_FColor getVertexColor() const
+    {
+        if (m_blendMode == BlendMode::PREMULTIPLIED)
+            return {m_alpha, m_alpha, m_alpha, m_alpha};
+        return {1.0f, 1.0f, 1.0f, m_alpha};
+    }
+
+    BlendMode getBlendMode() const { return m_blendMode; }
+    void setBlendMode(BlendMode mode) { m_blendMode = mode; }
+    SDL_BlendMode getSDLBlendMode() const;
+
+    SDL_Texture *getSDL() const { return m_texture.get(); }
+    const std::shared_ptr<SDL_Texture> &getShared() const { return m_texture; }
+
+    /// Size of the underlying SDL texture, for normalizing UVs.
+    int getSDLWidth() const { return m_sdlWidth; }
+    int getSDLHeight() const { return m_sdlHeight; }
 
 private:
-    SDL_Texture *m_texture;
+    void initFromSDL();
+
+    std::shared_ptr<SDL_Texture> m_texture;
+    Rect m_region{};
     int m_width{0};
     int m_height{0};
+    int m_sdlWidth{0};
+    int m_sdlHeight{0};
     Rect m_clipArea{};
+    std::vector<Rect> m_frames;
+    float m_alpha{1.0f};
+    BlendMode m_blendMode{BlendMode::BLEND};
 };
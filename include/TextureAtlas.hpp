@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "Rect.hpp"
+#include "Texture.hpp"
+
+/// Packs many images into a few large textures.
+///
+/// Images are sorted by height and placed with a skyline bottom-left packer
+/// into pages of at most `pageSize` x `pageSize` pixels, separated by
+/// `padding` transparent pixels so filtering does not bleed between them.
+/// `get` returns a Texture viewing the image's region of its page, so draws
+/// of different images from one page share an SDL texture and batch
+/// together.
+///
+/// With a `cachePath`, the packed pages are written next to it as PNGs along
+/// with a text index, and reused on the next run as long as every source
+/// image still has the same size and modification time.
+class TextureAtlas
+{
+public:
+    TextureAtlas(const std::vector<std::string> &paths, int pageSize = 2048, int padding = 1,
+                 const std::string &cachePath = "");
+
+    /// Texture for the image added as `path`; throws if it was not packed.
+    Texture get(const std::string &path) const;
+    bool contains(const std::string &path) const { return m_entries.count(path) != 0; }
+
+    size_t pageCount() const { return m_pages.size(); }
+    std::vector<std::string> getPaths() const;
+
+    /// True if the atlas was loaded from `cachePath` instead of packed.
+    bool isFromCache() const { return m_fromCache; }
+
+private:
+    struct Entry
+    {
+        size_t page;
+        Rect region;
+    };
+
+    struct Source
+    {
+        std::string path;
+        long long modified;
+        unsigned long long size;
+    };
+
+    void pack(const std::vector<Source> &sources, const std::string &cachePath);
+    bool loadCache(const std::string &cachePath, const std::vector<Source> &sources);
+    void saveCache(const std::string &cachePath, const std::vector<Source> &sources,
+                   const std::vector<SDL_Surface *> &pages) const;
+
+    int m_pageSize;
+    int m_padding;
+    bool m_fromCache{false};
+    std::vector<std::shared_ptr<SDL_Texture>> m_pages;
+    std::unordered_map<std::string, Entry> m_entries;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <SDL3/SDL.h>
+
+class Texture;
+
+/// Path-keyed texture cache with asynchronous loading.
+///
+/// Every load of a path shares one SDL texture while any Texture still uses
+/// it; the cache only holds weak references, so the GPU texture is freed when
+/// the last Texture goes away. `loadAsync` decodes the image on the job pool
+/// and the upload happens on the render thread in `present()`, which spends
+/// at most the upload budget per frame on finished decodes.
+namespace textures
+{
+    struct LoadState;
+
+    /// Handle to an asynchronous load. Requests for the same path while it
+    /// is in flight share their progress.
+    class Request
+    {
+    public:
+        explicit Request(std::shared_ptr<LoadState> state);
+
+        const std::string &getPath() const;
+
+        /// True once the texture is uploaded or the load has failed.
+        bool isDone() const;
+        bool hasFailed() const;
+        std::string getError() const;
+
+        /// The loaded texture. Blocks until decoding finishes and uploads
+        /// immediately if `present()` hasn't yet; throws if the load failed.
+        Texture get() const;
+
+    private:
+        std::shared_ptr<LoadState> m_state;
+
+        // Shared by every Request for the load. The load only holds it
+        // weakly, so once it expires nobody is waiting on the result.
+        std::shared_ptr<void> m_interest;
+    };
+
+    /// Shared SDL texture for `path`, loading it synchronously if it is not
+    /// cached. Waits for an in-flight asynchronous load of the same path.
+    std::shared_ptr<SDL_Texture> acquire(const std::string &path);
+
+    Request loadAsync(const std::string &path);
+
+    void setUploadBudget(double milliseconds);
+    double getUploadBudget();
+
+    /// Loads queued or decoded but not yet uploaded.
+    size_t pendingCount();
+
+    /// Paths whose texture is currently alive.
+    size_t cachedCount();
+
+    void _pump();
+    void _quit();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "Vec2.hpp"
+
+class AssetPack;
+class Texture;
+
+/// Image larger than the GPU allows in one texture, drawn as a grid of tile
+/// textures that are uploaded on demand.
+///
+/// Pixels stay in CPU memory: a texture entry of an AssetPack, read straight
+/// from the mapped file so only the rows of tiles that get uploaded are ever
+/// paged in, or a PNG decoded once. Drawing uploads the tiles that overlap
+/// the view and keeps them in least-recently-drawn order; once the resident
+/// tiles exceed the VRAM budget, the oldest ones not drawn this frame are
+/// freed. A view that needs more than the budget keeps its tiles until they
+/// fall out of view.
+///
+/// Each tile texture has a one-pixel gutter copied from its neighbors (or
+/// repeated from the image edge) and is sampled inside it, so linear
+/// filtering at fractional scales shows no seams between tiles.
+class TiledTexture
+{
+public:
+    /// The pack must outlive the TiledTexture.
+    TiledTexture(AssetPack &pack, const std::string &name, int tileSize = 1024);
+    explicit TiledTexture(const std::string &pngPath, int tileSize = 1024);
+    ~TiledTexture();
+
+    TiledTexture(const TiledTexture &) = delete;
+    TiledTexture &operator=(const TiledTexture &) = delete;
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getTileSize() const { return m_tileSize; }
+    size_t getTileCount() const { return m_tiles.size(); }
+
+    /// World position of the image's top-left corner, and its scale.
+    Vec2 getPosition() const { return m_position; }
+    void setPosition(const Vec2 &position) { m_position = position; }
+    Vec2 getScale() const { return m_scale; }
+    void setScale(const Vec2 &scale) { m_scale = scale; }
+
+    float getAlpha() const { return m_alpha; }
+    void setAlpha(float alpha) { m_alpha = alpha; }
+
+    /// Bytes of tile textures allowed to stay resident, 4 per pixel, gutters
+    /// included. 256 MiB by default.
+    void setBudget(size_t bytes) { m_budget = bytes; }
+    size_t getBudget() const { return m_budget; }
+
+    size_t getResidentBytes() const { return m_residentBytes; }
+    size_t getResidentTiles() const { return m_lru.size(); }
+
+    /// Tiles uploaded over the lifetime, and by the last render().
+    uint64_t getUploads() const { return m_uploads; }
+    size_t getLastUploads() const { return m_lastUploads; }
+
+    /// Draw the tiles overlapping the view, through the camera.
+    void render();
+
+    /// Free every tile texture.
+    void evictAll();
+
+private:
+    struct Tile
+    {
+        std::unique_ptr<Texture> texture;
+        std::list<size_t>::iterator lru;
+        uint64_t lastDrawn{0};
+    };
+
+    static constexpr int GUTTER = 1;
+
+    void init(int tileSize);
+    static size_t tileBytes(const SDL_Rect &rect);
+    SDL_Rect tileRect(size_t index) const;
+    Texture &upload(size_t index);
+    void evict(size_t index);
+
+    // Source pixels: a mapped pack entry, or a decoded PNG we own
+    const uint8_t *m_pixels{nullptr};
+    int m_pitch{0};
+    std::unique_ptr<SDL_Surface, void (*)(SDL_Surface *)> m_surface{nullptr, SDL_DestroySurface};
+    std::vector<uint8_t> m_staging; // one tile with its gutter, for upload
+
+    int m_width{0};
+    int m_height{0};
+    int m_tileSize{0};
+    int m_columns{0};
+    int m_rows{0};
+
+    Vec2 m_position;
+    Vec2 m_scale{1.0, 1.0};
+    float m_alpha{1.0f};
+
+    std::vector<Tile> m_tiles;
+    std::list<size_t> m_lru; // resident tiles, most recently drawn first
+    size_t m_budget{size_t{256} << 20};
+    size_t m_residentBytes{0};
+    uint64_t m_frame{0};
+    uint64_t m_uploads{0};
+    size_t m_lastUploads{0};
+    uint64_t m_generation{0};
+};
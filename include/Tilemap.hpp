@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+#include "Renderer.hpp"
+#include "Vec2.hpp"
+
+class Texture;
+
+/// Grid of tiles drawn from a tileset texture.
+///
+/// Tile ids index the tileset's frames (see Texture::setFrameGrid); ids that
+/// are negative or past the last frame are empty cells. The map is split
+/// into square chunks whose quads are built once, in map space, and rebuilt
+/// only after a tile in the chunk changes. Rendering picks the chunks that
+/// overlap the view, builds any stale ones in parallel, runs their vertices
+/// through the camera and submits them together, so the cost follows the
+/// number of visible tiles rather than the size of the map. Chunks that stay
+/// off screen for a while drop their vertices to bound memory on very large
+/// maps.
+class Tilemap
+{
+public:
+    static constexpr int32_t EMPTY = -1;
+
+    Tilemap(Texture *tileset, int columns, int rows, int tileWidth, int tileHeight, int chunkSize = 32);
+
+    int getColumns() const { return m_columns; }
+    int getRows() const { return m_rows; }
+    int getTileWidth() const { return m_tileWidth; }
+    int getTileHeight() const { return m_tileHeight; }
+    int getChunkSize() const { return m_chunkSize; }
+
+    int32_t getTile(int column, int row) const;
+    void setTile(int column, int row, int32_t id);
+
+    /// Replace every tile from row-major `ids` (rows x columns).
+    void setTiles(const int32_t *ids, size_t rows, size_t columns);
+    void fill(int32_t id);
+    const std::vector<int32_t> &getTiles() const { return m_tiles; }
+
+    /// World position of the map's top-left corner. Moving the map does not
+    /// rebuild chunks.
+    Vec2 getPosition() const { return m_position; }
+    void setPosition(const Vec2 &position) { m_position = position; }
+
+    Texture *getTileset() const { return m_tileset; }
+
+    void render();
+
+    /// Chunks currently holding vertices, and chunks drawn by the last
+    /// render().
+    size_t builtChunkCount() const { return m_built.size(); }
+    size_t drawnChunkCount() const { return m_visible.size(); }
+
+private:
+    struct Chunk
+    {
+        std::vector<SDL_Vertex> vertices;
+        bool dirty{true};
+        bool built{false};
+        uint64_t lastDrawn{0};
+    };
+
+    void markAllDirty();
+    void buildChunk(size_t chunk);
+    void evictChunks();
+    void drawFallback(Texture &tile, size_t chunk, size_t skip) const;
+
+    Texture *m_tileset;
+    int m_columns;
+    int m_rows;
+    int m_tileWidth;
+    int m_tileHeight;
+    int m_chunkSize;
+    int m_chunkColumns;
+    int m_chunkRows;
+    Vec2 m_position;
+
+    std::vector<int32_t> m_tiles;
+    std::vector<Chunk> m_chunks;
+
+    // Tileset state the built chunks used; a change rebuilds them all
+    renderer::FrameTable m_frames;
+    renderer::FrameTable m_scratchFrames;
+    SDL_FColor m_color{1.0f, 1.0f, 1.0f, 1.0f};
+
+    // Chunks holding vertices, chunks visible this frame and where each
+    // visible chunk's quads start in m_vertices (total at the end)
+    std::vector<size_t> m_built;
+    std::vector<size_t> m_visible;
+    std::vector<size_t> m_stale;
+    std::vector<size_t> m_offsets;
+    std::vector<SDL_Vertex> m_vertices;
+    uint64_t m_frame{0};
+};
@@ -8,5 +8,12 @@ namespace window
     bool isOpen();
     void close();
 
+    /// Run without a display: SDL's offscreen (or dummy) video driver, a
+    /// hidden window and the software renderer. Must be chosen before
+    /// init(). Also on when SDL was started with one of those drivers, e.g.
+    /// through SDL_VIDEO_DRIVER=offscreen, so scripts run unchanged.
+    void setHeadless(bool enabled);
+    bool isHeadless();
+
     void _quit();
 }
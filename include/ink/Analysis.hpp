@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include "AST.hpp"
+
+namespace ink
+{
+
+    /// Names of the fields and constants a behavior reads and assigns.
+    ///
+    /// Computed once after parsing so the host can skip work for derived data
+    /// that a script never touches.
+    struct FieldUsage
+    {
+        std::unordered_set<std::string> read;
+        std::unordered_set<std::string> written;
+
+        bool isRead(const std::string &name) const { return read.count(name) > 0; }
+        bool isWritten(const std::string &name) const { return written.count(name) > 0; }
+
+        /// True if any read / written name starts with `prefix` (e.g.
+        /// "neighbors.").
+        bool readsPrefix(const std::string &prefix) const;
+        bool writesPrefix(const std::string &prefix) const;
+    };
+
+    FieldUsage analyzeFields(const BehaviorDecl &behavior);
+
+} // namespace ink
@@ -13,9 +13,10 @@ namespace ink
     /// Vectorized tree-walking interpreter for Ink scripts.
     ///
     /// Each expression evaluates to a Value — either a scalar (broadcast to all
-    /// sprites) or a vector (one element per sprite). Binary operations between
-    /// a scalar and a vector reuse the vector's storage in-place, avoiding
-    /// unnecessary allocations.
+    /// sprites) or a vector (one element per sprite). Field reads borrow the
+    /// bound array instead of copying it, and operations reuse an operand's
+    /// owned storage in-place, so temporaries are only allocated when both
+    /// operands are borrowed.
     ///
     /// Conditional blocks (if/elif/else) use boolean masks so that assignments
     /// inside branches only affect the sprites whose condition was true.
@@ -25,6 +26,15 @@ namespace ink
         /// Register a mutable SoA field (e.g. "pos.x" → pointer to pos_x data).
         void bindField(const std::string &name, double *data);
 
+        /// Register a per-sprite field that scripts may read but not assign.
+        void bindReadOnlyField(const std::string &name, const double *data);
+
+        /// Register a read-only field that holds `source * factor`, where
+        /// `source` is a bound mutable field. `data` must be current when
+        /// bound; after an assignment to `source` it is recomputed on its
+        /// next read, so reads always see the value the script just set.
+        void bindScaledField(const std::string &name, double *data, const double *source, double factor);
+
         /// Register a read-only constant broadcast to all sprites (e.g. "dt", "PI").
         void setConstant(const std::string &name, double value);
 
@@ -34,17 +44,28 @@ namespace ink
         /// Execute a parsed behavior on the currently bound arrays.
         void execute(const BehaviorDecl &behavior);
 
+        /// True if the last execute() assigned to `field` for at least one
+        /// sprite. Branches whose mask is empty are skipped, so a field written
+        /// only inside an untaken branch does not count.
+        bool wasWritten(const double *field) const;
+
     private:
-        // Internal value type: scalar or per-sprite vector
+        // Internal value type: scalar, owned per-sprite vector, or a borrowed
+        // view of a bound field
         struct Value
         {
             std::vector<double> vec;
+            const double *view{nullptr};
             double scalar{0.0};
             bool isScalar{false};
 
             Value() : isScalar(true) {}
             explicit Value(double s) : scalar(s), isScalar(true) {}
             explicit Value(std::vector<double> &&v) : vec(std::move(v)), isScalar(false) {}
+            explicit Value(const double *field) : view(field), isScalar(false) {}
+
+            bool isOwned() const { return !isScalar && !view; }
+            const double *data() const { return view ? view : vec.data(); }
         };
 
         // Expression evaluation
@@ -56,13 +77,29 @@ namespace ink
         void execIf(const IfStmt &stmt);
         void execAssign(const AssignStmt &stmt);
         void execCompoundAssign(const CompoundAssignStmt &stmt);
+        void recordWrite(const double *field);
+        std::unordered_map<std::string, double *>::iterator findAssignable(const std::string &target);
 
         // Active mask (1.0 = sprite participates, 0.0 = masked out)
         std::vector<double> m_activeMask;
         std::vector<std::vector<double>> m_maskStack;
 
+        // Fields assigned during the current execute()
+        std::vector<const double *> m_written;
+
+        // Read-only per-sprite field; scaled fields also carry their source
+        struct ReadOnlyField
+        {
+            const double *data{nullptr};
+            double *scaled{nullptr};
+            const double *source{nullptr};
+            double factor{1.0};
+            bool stale{false};
+        };
+
         // Bindings
         std::unordered_map<std::string, double *> m_fields;
+        std::unordered_map<std::string, ReadOnlyField> m_readOnly;
         std::unordered_map<std::string, double> m_constants;
         size_t m_count{0};
     };
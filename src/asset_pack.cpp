@@ -0,0 +1,305 @@
+#include "AssetPack.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Renderer.hpp"
+
+namespace fs = std::filesystem;
+
+static_assert(std::endian::native == std::endian::little, "Asset packs are little-endian");
+
+constexpr char PACK_MAGIC[8] = {'G', 'O', 'O', 'B', 'P', 'A', 'C', 'K'};
+constexpr uint32_t PACK_VERSION = 1;
+constexpr uint64_t PAYLOAD_ALIGNMENT = 64;
+
+// On-disk structures, read with memcpy so the mapping needs no alignment
+struct PackHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+struct PackEntry
+{
+    uint32_t type;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+static_assert(sizeof(PackHeader) == 32 && sizeof(PackEntry) == 40, "Pack layout changed");
+
+static uint64_t alignUp(uint64_t value)
+{
+    return (value + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1);
+}
+
+static void writePadding(std::ofstream &out, uint64_t to)
+{
+    static const char zeros[PAYLOAD_ALIGNMENT] = {};
+    uint64_t at = static_cast<uint64_t>(out.tellp());
+    if (to > at)
+        out.write(zeros, static_cast<std::streamsize>(to - at));
+}
+
+void AssetPack::build(const std::string &outPath, const std::vector<std::string> &files,
+                      const std::string &root)
+{
+    std::vector<PackEntry> index(files.size());
+    std::string names;
+
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        const fs::path file(files[i]);
+        const std::string extension = file.extension().string();
+        if (extension == ".png")
+            index[i].type = static_cast<uint32_t>(EntryType::TEXTURE);
+        else if (extension == ".ink")
+            index[i].type = static_cast<uint32_t>(EntryType::SCRIPT);
+        else
+            throw std::invalid_argument("Unsupported asset type: " + files[i]);
+
+        const std::string name = root.empty()
+                                     ? file.generic_string()
+                                     : fs::relative(file, root).generic_string();
+        index[i].nameOffset = static_cast<uint32_t>(names.size());
+        index[i].nameLength = static_cast<uint32_t>(name.size());
+        names += name;
+    }
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+        throw std::runtime_error("Failed to write asset pack: " + outPath);
+
+    PackHeader header{};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(files.size());
+    header.namesOffset = sizeof(PackHeader) + sizeof(PackEntry) * files.size();
+    header.namesSize = names.size();
+
+    // The index is written again once payload offsets are known
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(index.data()), sizeof(PackEntry) * index.size());
+    out.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+    // Payloads are streamed one at a time so large packs don't sit in memory
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        PackEntry &entry = index[i];
+        entry.dataOffset = alignUp(static_cast<uint64_t>(out.tellp()));
+        writePadding(out, entry.dataOffset);
+
+        if (entry.type == static_cast<uint32_t>(EntryType::SCRIPT))
+        {
+            std::ifstream script(files[i], std::ios::binary);
+            if (!script.is_open())
+                throw std::runtime_error("Ink: could not open script '" + files[i] + "'");
+            out << script.rdbuf();
+            entry.dataSize = static_cast<uint64_t>(out.tellp()) - entry.dataOffset;
+            continue;
+        }
+
+        SDL_Surface *loaded = SDL_LoadPNG(files[i].c_str());
+        if (!loaded)
+            throw std::runtime_error("Failed to load image: " + std::string(SDL_GetError()));
+        SDL_Surface *rgba = SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32);
+        SDL_DestroySurface(loaded);
+        if (!rgba)
+            throw std::runtime_error("Failed to convert image: " + std::string(SDL_GetError()));
+
+        // Tightly packed rows
+        entry.width = static_cast<uint32_t>(rgba->w);
+        entry.height = static_cast<uint32_t>(rgba->h);
+        entry.pitch = entry.width * 4;
+        entry.dataSize = static_cast<uint64_t>(entry.pitch) * entry.height;
+        const auto *pixels = static_cast<const char *>(rgba->pixels);
+        for (int y = 0; y < rgba->h; y++)
+            out.write(pixels + static_cast<size_t>(y) * rgba->pitch, entry.pitch);
+        SDL_DestroySurface(rgba);
+    }
+
+    out.seekp(sizeof(PackHeader));
+    out.write(reinterpret_cast<const char *>(index.data()), sizeof(PackEntry) * index.size());
+    if (!out)
+        throw std::runtime_error("Failed to write asset pack: " + outPath);
+}
+
+static void unmap(const uint8_t *data, size_t size)
+{
+    if (!data)
+        return;
+#ifdef _WIN32
+    (void)size;
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<uint8_t *>(data), size);
+#endif
+}
+
+AssetPack::AssetPack(const std::string &path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileW(fs::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open asset pack: " + path);
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        throw std::runtime_error("Failed to map asset pack: " + path);
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+        throw std::runtime_error("Failed to map asset pack: " + path);
+
+    m_data = static_cast<const uint8_t *>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open asset pack: " + path);
+
+    struct stat info;
+    void *view = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        throw std::runtime_error("Failed to map asset pack: " + path);
+
+    m_data = static_cast<const uint8_t *>(view);
+    m_size = static_cast<size_t>(info.st_size);
+#endif
+
+    // Validate everything up front so lookups can trust the index
+    try
+    {
+        PackHeader header;
+        if (m_size < sizeof(header))
+            throw std::runtime_error("Not an asset pack: " + path);
+        std::memcpy(&header, m_data, sizeof(header));
+        if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0)
+            throw std::runtime_error("Not an asset pack: " + path);
+        if (header.version != PACK_VERSION)
+            throw std::runtime_error("Unsupported asset pack version: " + path);
+
+        const uint64_t indexEnd = sizeof(PackHeader) + uint64_t{sizeof(PackEntry)} * header.entryCount;
+        if (indexEnd > m_size || header.namesOffset < indexEnd ||
+            header.namesOffset + header.namesSize > m_size)
+            throw std::runtime_error("Corrupt asset pack: " + path);
+
+        const char *names = reinterpret_cast<const char *>(m_data + header.namesOffset);
+        for (uint32_t i = 0; i < header.entryCount; i++)
+        {
+            PackEntry raw;
+            std::memcpy(&raw, m_data + sizeof(PackHeader) + sizeof(PackEntry) * i, sizeof(raw));
+
+            const bool texture = raw.type == static_cast<uint32_t>(EntryType::TEXTURE);
+            const bool script = raw.type == static_cast<uint32_t>(EntryType::SCRIPT);
+            if ((!texture && !script) ||
+                uint64_t{raw.nameOffset} + raw.nameLength > header.namesSize ||
+                raw.dataOffset > m_size || raw.dataSize > m_size - raw.dataOffset ||
+                (texture && (raw.width == 0 || raw.height == 0 ||
+                             raw.pitch < uint64_t{raw.width} * 4 ||
+                             uint64_t{raw.pitch} * raw.height > raw.dataSize)))
+                throw std::runtime_error("Corrupt asset pack: " + path);
+
+            Entry entry{static_cast<EntryType>(raw.type), raw.width, raw.height, raw.pitch,
+                        m_data + raw.dataOffset, raw.dataSize};
+            m_entries[std::string(names + raw.nameOffset, raw.nameLength)] = entry;
+        }
+    }
+    catch (...)
+    {
+        unmap(m_data, m_size);
+        throw;
+    }
+}
+
+AssetPack::~AssetPack()
+{
+    unmap(m_data, m_size);
+}
+
+std::vector<std::string> AssetPack::getNames() const
+{
+    std::vector<std::string> names;
+    names.reserve(m_entries.size());
+    for (const auto &[name, entry] : m_entries)
+        names.push_back(name);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+const AssetPack::Entry &AssetPack::find(const std::string &name, EntryType type) const
+{
+    auto it = m_entries.find(name);
+    if (it == m_entries.end() || it->second.type != type)
+        throw std::invalid_argument("Asset not in pack: " + name);
+    return it->second;
+}
+
+Texture AssetPack::getTexture(const std::string &name)
+{
+    auto cached = m_textures.find(name);
+    if (cached != m_textures.end())
+    {
+        if (auto texture = cached->second.lock())
+            return Texture(texture);
+    }
+
+    const Entry &entry = find(name, EntryType::TEXTURE);
+    SDL_Texture *created = SDL_CreateTexture(
+        renderer::_get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+        static_cast<int>(entry.width), static_cast<int>(entry.height));
+    if (!created)
+        throw std::runtime_error("Failed to create texture: " + std::string(SDL_GetError()));
+    auto texture = Texture::share(created);
+
+    // Straight from the mapped pages to the GPU
+    if (!SDL_UpdateTexture(texture.get(), nullptr, entry.data, static_cast<int>(entry.pitch)))
+        throw std::runtime_error("Failed to upload texture: " + std::string(SDL_GetError()));
+
+    m_textures[name] = texture;
+    return Texture(texture);
+}
+
+AssetPack::Image AssetPack::getImage(const std::string &name) const
+{
+    const Entry &entry = find(name, EntryType::TEXTURE);
+    return {entry.data, static_cast<int>(entry.width), static_cast<int>(entry.height), static_cast<int>(entry.pitch)};
+}
+
+std::string AssetPack::getScript(const std::string &name) const
+{
+    const Entry &entry = find(name, EntryType::SCRIPT);
+    return std::string(reinterpret_cast<const char *>(entry.data), entry.size);
+}
@@ -0,0 +1,76 @@
+#include "CachedLayer.hpp"
+
+#include <stdexcept>
+
+#include "InkSprites.hpp"
+#include "Renderer.hpp"
+
+static std::shared_ptr<SDL_Texture> createTarget(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("Cached layer size must be positive");
+
+    SDL_Texture *texture = SDL_CreateTexture(
+        renderer::_get(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture)
+        throw std::runtime_error("Failed to create cached layer: " + std::string(SDL_GetError()));
+    return Texture::share(texture);
+}
+
+CachedLayer::CachedLayer(int width, int height)
+    : m_texture(createTarget(width, height)), m_generation(renderer::target_generation())
+{
+    m_texture.setBlendMode(Texture::BlendMode::PREMULTIPLIED);
+}
+
+void CachedLayer::begin()
+{
+    if (m_recording)
+        throw std::runtime_error("Cached layer is already recording");
+
+    m_previousTarget = renderer::get_target();
+    m_previousCamera = renderer::get_camera();
+    renderer::set_target(m_texture.getSDL());
+    renderer::set_camera(Camera{});
+    m_recording = true;
+    renderer::clear({0, 0, 0, 0});
+}
+
+void CachedLayer::end()
+{
+    if (!m_recording)
+        throw std::runtime_error("Cached layer is not recording");
+
+    m_recording = false;
+    renderer::set_target(m_previousTarget);
+    renderer::set_camera(m_previousCamera);
+    m_dirty = false;
+    m_generation = renderer::target_generation();
+}
+
+bool CachedLayer::isDirty() const
+{
+    return m_dirty || m_generation != renderer::target_generation();
+}
+
+bool CachedLayer::update(InkSprites &sprites, const Vec2 &anchor, const Vec2 &pivot)
+{
+    if (!isDirty() && m_source == &sprites && m_sourceVersion == sprites.getVersion())
+        return false;
+
+    begin();
+    sprites.render(anchor, pivot);
+    end();
+
+    m_source = &sprites;
+    m_sourceVersion = sprites.getVersion();
+    return true;
+}
+
+void CachedLayer::draw(const Transform &transform, const Vec2 &anchor, const Vec2 &pivot, int layer)
+{
+    if (m_recording)
+        throw std::runtime_error("Cached layer cannot draw itself while recording");
+
+    renderer::draw(m_texture, transform, anchor, pivot, layer);
+}
@@ -0,0 +1,431 @@
+#include "Capture.hpp"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+namespace capture
+{
+    // What the writer needs to know about a capture
+    struct Output
+    {
+        std::string path;
+        Format format;
+        bool singleFile;
+        std::ofstream file;
+    };
+
+    // Render-thread state
+    static std::shared_ptr<SDL_Texture> _targets[2];
+    static int _current = 0;
+    static bool _unread[2] = {false, false}; // target holds a frame not read back yet
+    static bool _active = false;
+    static bool _stopping = false;
+    static size_t _frameLimit = 0;
+    static uint64_t _drawn = 0;
+    static size_t _queueSize = 8;
+    static QueuePolicy _policy = QueuePolicy::DROP;
+    static uint64_t _renderNs = 0;
+
+    // Shared with the writer
+    static std::mutex _mutex;
+    static std::condition_variable _queueCv; // frames added, or closing
+    static std::condition_variable _spaceCv; // frames taken, or all written
+    static std::deque<SDL_Surface *> _queue;
+    static bool _closing = false;
+    static Stats _stats;
+    static uint64_t _encodeNs = 0;
+    static uint64_t _startNs = 0;
+    static uint64_t _endNs = 0;
+    static std::thread _writer;
+
+    static std::string framePath(const std::string &path, uint64_t index)
+    {
+        const size_t slash = path.find_last_of("/\\");
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            dot = path.size();
+
+        char number[32];
+        std::snprintf(number, sizeof(number), "_%06llu", static_cast<unsigned long long>(index));
+        return path.substr(0, dot) + number + path.substr(dot);
+    }
+
+    // Full-range RGB to BT.601 studio-swing YUV, one plane after another
+    static void toYuv444(const SDL_Surface *surface, std::vector<uint8_t> &out)
+    {
+        const size_t plane = static_cast<size_t>(surface->w) * surface->h;
+        out.resize(plane * 3);
+        uint8_t *y = out.data();
+        uint8_t *u = y + plane;
+        uint8_t *v = u + plane;
+
+        for (int row = 0; row < surface->h; row++)
+        {
+            const uint8_t *px = static_cast<const uint8_t *>(surface->pixels) + static_cast<size_t>(row) * surface->pitch;
+            for (int x = 0; x < surface->w; x++, px += 4)
+            {
+                const int r = px[0], g = px[1], b = px[2];
+                *y++ = static_cast<uint8_t>(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+                *u++ = static_cast<uint8_t>(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+                *v++ = static_cast<uint8_t>(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+            }
+        }
+    }
+
+    // Drop a partly written frame so the next one starts on a frame
+    // boundary, then report the failure
+    [[noreturn]] static void rewind(Output &output, std::streampos start)
+    {
+        output.file.clear();
+        if (start != std::streampos(-1))
+            output.file.seekp(start);
+        throw std::runtime_error("Failed to write capture frame: " + output.path);
+    }
+
+    // Returns the bytes written; throws on failure
+    static uint64_t writeFrame(Output &output, SDL_Surface *surface, uint64_t index, std::vector<uint8_t> &scratch)
+    {
+        switch (output.format)
+        {
+        case Format::RAW:
+        {
+            const std::streampos start = output.file.tellp();
+            const size_t row = static_cast<size_t>(surface->w) * 4;
+            for (int y = 0; y < surface->h; y++)
+                output.file.write(static_cast<const char *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch, row);
+            if (!output.file)
+                rewind(output, start);
+            return row * surface->h;
+        }
+
+        case Format::Y4M:
+        {
+            const std::streampos start = output.file.tellp();
+            toYuv444(surface, scratch);
+            output.file << "FRAME\n";
+            output.file.write(reinterpret_cast<const char *>(scratch.data()), scratch.size());
+            if (!output.file)
+                rewind(output, start);
+            return scratch.size() + 6;
+        }
+
+        case Format::PNG:
+        default:
+        {
+            const std::string path = output.singleFile ? output.path : framePath(output.path, index);
+            if (!SDL_SavePNG(surface, path.c_str()))
+                throw std::runtime_error("Failed to save capture: " + std::string(SDL_GetError()));
+            std::error_code error;
+            const uintmax_t size = std::filesystem::file_size(path, error);
+            return error ? 0 : size;
+        }
+        }
+    }
+
+    static void writerLoop(std::shared_ptr<Output> output)
+    {
+        std::vector<uint8_t> scratch;
+        uint64_t index = 0;
+
+        std::unique_lock lock(_mutex);
+        while (true)
+        {
+            _queueCv.wait(lock, []
+                          { return !_queue.empty() || _closing; });
+            if (_queue.empty())
+                break;
+
+            SDL_Surface *surface = _queue.front();
+            _queue.pop_front();
+            _spaceCv.notify_all();
+            lock.unlock();
+
+            const uint64_t start = SDL_GetTicksNS();
+            uint64_t bytes = 0;
+            std::string error;
+            SDL_Surface *rgba = surface->format == SDL_PIXELFORMAT_RGBA32
+                                    ? surface
+                                    : SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+            if (!rgba)
+            {
+                error = "Failed to convert capture: " + std::string(SDL_GetError());
+            }
+            else
+            {
+                try
+                {
+                    bytes = writeFrame(*output, rgba, index, scratch);
+                }
+                catch (const std::exception &e)
+                {
+                    error = e.what();
+                }
+            }
+            if (rgba && rgba != surface)
+                SDL_DestroySurface(rgba);
+            SDL_DestroySurface(surface);
+            const uint64_t elapsed = SDL_GetTicksNS() - start;
+
+            lock.lock();
+            _encodeNs += elapsed;
+            if (!error.empty())
+            {
+                // Only this frame is lost; later ones are still written
+                _stats.failed++;
+                _stats.error = error;
+            }
+            else
+            {
+                _stats.written++;
+                _stats.bytesWritten += bytes;
+                index++;
+            }
+            _spaceCv.notify_all();
+        }
+
+        if (output->file.is_open())
+            output->file.close();
+        _endNs = SDL_GetTicksNS();
+        _spaceCv.notify_all();
+    }
+
+    static void finish()
+    {
+        _active = false;
+        _stopping = false;
+        _unread[0] = _unread[1] = false;
+        _targets[0].reset();
+        _targets[1].reset();
+
+        std::lock_guard lock(_mutex);
+        _closing = true;
+        _queueCv.notify_all();
+    }
+
+    static void enqueue(SDL_Surface *surface)
+    {
+        std::unique_lock lock(_mutex);
+        if (_queue.size() >= _queueSize)
+        {
+            if (_policy == QueuePolicy::DROP)
+            {
+                _stats.dropped++;
+                lock.unlock();
+                SDL_DestroySurface(surface);
+                return;
+            }
+            _spaceCv.wait(lock, []
+                          { return _queue.size() < _queueSize; });
+        }
+        _queue.push_back(surface);
+        _stats.captured++;
+        _queueCv.notify_one();
+    }
+
+    static void readBack(SDL_Texture *target)
+    {
+        SDL_Renderer *sdlRenderer = renderer::_get();
+        SDL_Texture *previous = SDL_GetRenderTarget(sdlRenderer);
+        SDL_SetRenderTarget(sdlRenderer, target);
+        SDL_Surface *surface = SDL_RenderReadPixels(sdlRenderer, nullptr);
+        SDL_SetRenderTarget(sdlRenderer, previous);
+
+        if (surface)
+        {
+            enqueue(surface);
+            return;
+        }
+
+        std::lock_guard lock(_mutex);
+        _stats.failed++;
+        _stats.error = "Failed to read back capture: " + std::string(SDL_GetError());
+    }
+
+    static std::shared_ptr<SDL_Texture> createTarget(int width, int height)
+    {
+        SDL_Texture *texture = SDL_CreateTexture(
+            renderer::_get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, width, height);
+        if (!texture)
+            throw std::runtime_error("Failed to create capture target: " + std::string(SDL_GetError()));
+
+        // Copied to the window as is
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_NONE);
+        return Texture::share(texture);
+    }
+
+    void start(const std::string &path, Format format, size_t frameLimit,
+               size_t queueSize, QueuePolicy policy, int fps)
+    {
+        if (_active)
+            throw std::runtime_error("A capture is already running");
+        if (path.empty())
+            throw std::invalid_argument("Capture path cannot be empty");
+        if (queueSize == 0)
+            throw std::invalid_argument("Capture queue needs room for at least one frame");
+        if (fps <= 0)
+            throw std::invalid_argument("Capture frame rate must be positive");
+
+        // The previous capture's writer finishes first
+        wait();
+
+        // The window's drawing area: the logical size when letterboxing
+        SDL_Renderer *sdlRenderer = renderer::_get();
+        int width = 0, height = 0;
+        SDL_RendererLogicalPresentation mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+        if (!SDL_GetRenderLogicalPresentation(sdlRenderer, &width, &height, &mode) ||
+            mode == SDL_LOGICAL_PRESENTATION_DISABLED)
+        {
+            SDL_GetRenderOutputSize(sdlRenderer, &width, &height);
+        }
+        if (width <= 0 || height <= 0)
+            throw std::runtime_error("Nothing to capture: the window has no size");
+
+        auto output = std::make_shared<Output>();
+        output->path = path;
+        output->format = format;
+        output->singleFile = frameLimit == 1;
+        if (format != Format::PNG)
+        {
+            output->file.open(path, std::ios::binary | std::ios::trunc);
+            if (!output->file.is_open())
+                throw std::runtime_error("Failed to open capture file: " + path);
+            if (format == Format::Y4M)
+                output->file << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C444\n";
+        }
+
+        _targets[0] = createTarget(width, height);
+        _targets[1] = createTarget(width, height);
+        _current = 0;
+        _unread[0] = _unread[1] = false;
+        _drawn = 0;
+        _frameLimit = frameLimit;
+        _queueSize = queueSize;
+        _policy = policy;
+        _renderNs = 0;
+
+        {
+            std::lock_guard lock(_mutex);
+            _stats = {};
+            _encodeNs = 0;
+            _startNs = SDL_GetTicksNS();
+            _endNs = 0;
+            _closing = false;
+        }
+        _active = true;
+        _writer = std::thread(writerLoop, std::move(output));
+    }
+
+    void screenshot(const std::string &path)
+    {
+        start(path, Format::PNG, 1);
+    }
+
+    void stop()
+    {
+        if (_active)
+            _stopping = true;
+    }
+
+    bool isActive()
+    {
+        return _active;
+    }
+
+    void wait()
+    {
+        if (_active)
+            throw std::runtime_error("Capture is still running; stop() it and present() first");
+        if (_writer.joinable())
+            _writer.join();
+    }
+
+    Stats getStats()
+    {
+        std::lock_guard lock(_mutex);
+        Stats stats = _stats;
+        stats.queued = _queue.size();
+
+        const uint64_t end = _endNs ? _endNs : SDL_GetTicksNS();
+        if (_startNs && end > _startNs)
+            stats.writtenPerSecond = stats.written * 1e9 / static_cast<double>(end - _startNs);
+        if (_drawn)
+            stats.renderMs = _renderNs / 1e6 / _drawn;
+        if (stats.written)
+            stats.encodeMs = _encodeNs / 1e6 / stats.written;
+        return stats;
+    }
+
+    SDL_Texture *_target()
+    {
+        return _active ? _targets[_current].get() : nullptr;
+    }
+
+    void _begin()
+    {
+        if (!_active || !_unread[_current])
+            return;
+
+        // The target is about to be drawn again; its frame was submitted a
+        // whole frame ago, so the GPU has usually finished it
+        const uint64_t start = SDL_GetTicksNS();
+        readBack(_targets[_current].get());
+        _unread[_current] = false;
+        _renderNs += SDL_GetTicksNS() - start;
+    }
+
+    void _present(bool drawn)
+    {
+        if (!_active)
+            return;
+
+        const uint64_t start = SDL_GetTicksNS();
+        if (drawn)
+        {
+            // Show this frame; it is read back when its target comes round
+            // again, by _begin() two frames from now
+            SDL_Renderer *sdlRenderer = renderer::_get();
+            SDL_SetRenderTarget(sdlRenderer, nullptr);
+            SDL_RenderTexture(sdlRenderer, _targets[_current].get(), nullptr, nullptr);
+
+            _unread[_current] = true;
+            _current = 1 - _current;
+
+            _drawn++;
+            if (_frameLimit && _drawn >= _frameLimit)
+                _stopping = true;
+        }
+
+        if (_stopping)
+        {
+            // Nothing more will be drawn, so read what is left now, oldest
+            // first; this waits for the GPU to finish the last frame
+            for (int i = 0; i < 2; i++)
+            {
+                const int target = (_current + i) % 2;
+                if (_unread[target])
+                    readBack(_targets[target].get());
+            }
+            finish();
+        }
+        _renderNs += SDL_GetTicksNS() - start;
+    }
+
+    void _quit()
+    {
+        if (_active)
+            finish();
+        if (_writer.joinable())
+            _writer.join();
+    }
+}
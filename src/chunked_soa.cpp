@@ -0,0 +1,122 @@
+#include "ChunkedSoA.hpp"
+
+#include <new>
+#include <algorithm>
+#include <cstring>
+
+ChunkedSoA::ChunkedSoA(size_t columns)
+    : m_columns(columns)
+{
+}
+
+ChunkedSoA::~ChunkedSoA()
+{
+    for (double *block : m_blocks)
+        freeBlock(block);
+    releasePool();
+}
+
+size_t ChunkedSoA::blockSize(size_t block) const
+{
+    size_t start = block * BLOCK_SIZE;
+    return std::min(BLOCK_SIZE, m_size - start);
+}
+
+void ChunkedSoA::grow(size_t count)
+{
+    size_t newSize = m_size + count;
+    size_t needed = (newSize + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    while (m_blocks.size() < needed)
+    {
+        if (!m_pool.empty())
+        {
+            m_blocks.push_back(m_pool.back());
+            m_pool.pop_back();
+        }
+        else
+        {
+            m_blocks.push_back(allocBlock(blockBytes()));
+        }
+    }
+
+    m_size = newSize;
+}
+
+void ChunkedSoA::shrink(size_t count)
+{
+    m_size -= std::min(count, m_size);
+    size_t needed = blockCount();
+
+    while (m_blocks.size() > needed)
+    {
+        double *block = m_blocks.back();
+        m_blocks.pop_back();
+
+        if (m_pool.size() < MAX_POOLED_BLOCKS)
+            m_pool.push_back(block);
+        else
+            freeBlock(block);
+    }
+}
+
+void ChunkedSoA::copyElement(size_t dst, size_t src)
+{
+    double *dstBlock = m_blocks[dst / BLOCK_SIZE] + dst % BLOCK_SIZE;
+    const double *srcBlock = m_blocks[src / BLOCK_SIZE] + src % BLOCK_SIZE;
+    for (size_t c = 0; c < m_columns; c++)
+        dstBlock[c * BLOCK_SIZE] = srcBlock[c * BLOCK_SIZE];
+}
+
+size_t ChunkedSoA::addColumns(size_t count, double value)
+{
+    const size_t first = m_columns;
+    const size_t oldBytes = m_columns * BLOCK_SIZE * sizeof(double);
+    const size_t newBytes = (m_columns + count) * BLOCK_SIZE * sizeof(double);
+
+    // Allocate every wider block before touching the old ones, so a failed
+    // allocation leaves the container as it was
+    std::vector<double *> resized;
+    resized.reserve(m_blocks.size());
+    try
+    {
+        for (size_t b = 0; b < m_blocks.size(); b++)
+            resized.push_back(allocBlock(newBytes));
+    }
+    catch (...)
+    {
+        for (double *block : resized)
+            freeBlock(block);
+        throw;
+    }
+
+    for (size_t b = 0; b < m_blocks.size(); b++)
+    {
+        std::memcpy(resized[b], m_blocks[b], oldBytes);
+        std::fill_n(resized[b] + first * BLOCK_SIZE, count * BLOCK_SIZE, value);
+        freeBlock(m_blocks[b]);
+    }
+    m_blocks.swap(resized);
+    m_columns += count;
+
+    // Pooled blocks have the old layout
+    releasePool();
+    return first;
+}
+
+void ChunkedSoA::releasePool()
+{
+    for (double *block : m_pool)
+        freeBlock(block);
+    m_pool.clear();
+}
+
+double *ChunkedSoA::allocBlock(size_t bytes)
+{
+    return static_cast<double *>(::operator new(bytes, std::align_val_t(ALIGNMENT)));
+}
+
+void ChunkedSoA::freeBlock(double *block)
+{
+    ::operator delete(block, std::align_val_t(ALIGNMENT));
+}
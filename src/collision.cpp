@@ -0,0 +1,243 @@
+#include "Collision.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "ChunkedSoA.hpp"
+#include "InkSprites.hpp"
+#include "Jobs.hpp"
+#include "SpatialGrid.hpp"
+#include "Texture.hpp"
+
+namespace collision
+{
+    enum BoxField : size_t
+    {
+        X0,
+        Y0,
+        W,
+        H,
+        BOX_FIELD_COUNT
+    };
+
+    // Grid over one side's boxes, reused between calls
+    struct BoxGrid
+    {
+        ChunkedSoA boxes{BOX_FIELD_COUNT};
+        SpatialGrid grid;
+        double maxW{0.0};
+        double maxH{0.0};
+    };
+
+    static BoxGrid _boxGrid;
+    static std::vector<std::vector<uint32_t>> _rangePairs;
+
+    static void computeBoxes(
+        const InkSprites &sprites, const Vec2 &anchor, size_t block,
+        double *x0, double *y0, double *w, double *h)
+    {
+        const ChunkedSoA &data = sprites.data();
+        const Rect clip = sprites.getTexture()->getClipArea();
+        const double *px = data.column(block, InkSprites::POS_X);
+        const double *py = data.column(block, InkSprites::POS_Y);
+        const double *sx = data.column(block, InkSprites::SCALE_X);
+        const double *sy = data.column(block, InkSprites::SCALE_Y);
+
+        size_t n = data.blockSize(block);
+        for (size_t i = 0; i < n; i++)
+        {
+            w[i] = clip.w * std::abs(sx[i]);
+            h[i] = clip.h * std::abs(sy[i]);
+            x0[i] = px[i] - w[i] * anchor.x;
+            y0[i] = py[i] - h[i] * anchor.y;
+        }
+    }
+
+    static void buildBoxGrid(const InkSprites &sprites, const Vec2 &anchor, BoxGrid &out)
+    {
+        ChunkedSoA &boxes = out.boxes;
+        const ChunkedSoA &data = sprites.data();
+        if (boxes.size() > data.size())
+            boxes.shrink(boxes.size() - data.size());
+        else
+            boxes.grow(data.size() - boxes.size());
+
+        jobs::parallelFor(data.blockCount(), 4, [&](size_t begin, size_t end)
+                          {
+            for (size_t b = begin; b < end; b++)
+            {
+                computeBoxes(sprites, anchor, b,
+                             boxes.column(b, X0), boxes.column(b, Y0),
+                             boxes.column(b, W), boxes.column(b, H));
+            } });
+
+        double minX = std::numeric_limits<double>::max(), minY = minX;
+        double maxX = std::numeric_limits<double>::lowest(), maxY = maxX;
+        out.maxW = 0.0;
+        out.maxH = 0.0;
+        for (size_t b = 0; b < boxes.blockCount(); b++)
+        {
+            const double *x0 = boxes.column(b, X0);
+            const double *y0 = boxes.column(b, Y0);
+            const double *w = boxes.column(b, W);
+            const double *h = boxes.column(b, H);
+            size_t n = boxes.blockSize(b);
+            for (size_t i = 0; i < n; i++)
+            {
+                minX = std::min(minX, x0[i]);
+                maxX = std::max(maxX, x0[i]);
+                minY = std::min(minY, y0[i]);
+                maxY = std::max(maxY, y0[i]);
+                out.maxW = std::max(out.maxW, w[i]);
+                out.maxH = std::max(out.maxH, h[i]);
+            }
+        }
+
+        // Cells about as large as the biggest box keep queries to ~3x3 cells;
+        // widen them if the spread of boxes would exceed the cell budget.
+        Rect bounds{minX, minY, std::max(maxX - minX, 1.0), std::max(maxY - minY, 1.0)};
+        double cellSize = std::max({out.maxW, out.maxH, 1.0});
+        double budget = static_cast<double>(SpatialGrid::MAX_CELLS / 2);
+        if ((bounds.w / cellSize + 1.0) * (bounds.h / cellSize + 1.0) > budget)
+            cellSize = std::sqrt(bounds.w * bounds.h / budget) + 1.0;
+
+        out.grid.configure(bounds, cellSize);
+        out.grid.rebuild(boxes, X0, Y0, {W, H});
+    }
+
+    // Call fn(gridIndex) for every grid box that overlaps [x0, x1) x [y0, y1)
+    template <typename Fn>
+    static void forEachOverlap(const BoxGrid &grid, double x0, double y0, double x1, double y1, Fn &&fn)
+    {
+        grid.grid.forEachCandidate(
+            x0 - grid.maxW, y0 - grid.maxH, x1, y1,
+            [&](size_t slot)
+            {
+                double bx = grid.grid.xAt(slot);
+                double by = grid.grid.yAt(slot);
+                if (bx < x1 && x0 < bx + grid.grid.payloadAt(0, slot) &&
+                    by < y1 && y0 < by + grid.grid.payloadAt(1, slot))
+                    fn(grid.grid.indexAt(slot));
+            });
+    }
+
+    static std::vector<uint32_t> gatherRanges(size_t ranges)
+    {
+        size_t total = 0;
+        for (size_t r = 0; r < ranges; r++)
+            total += _rangePairs[r].size();
+
+        std::vector<uint32_t> pairs;
+        pairs.reserve(total);
+        for (size_t r = 0; r < ranges; r++)
+            pairs.insert(pairs.end(), _rangePairs[r].begin(), _rangePairs[r].end());
+        return pairs;
+    }
+
+    static void prepareRanges(size_t ranges)
+    {
+        if (_rangePairs.size() < ranges)
+            _rangePairs.resize(ranges);
+        for (size_t r = 0; r < ranges; r++)
+            _rangePairs[r].clear();
+    }
+
+    std::vector<uint32_t> spritePairs(
+        InkSprites &a, InkSprites &b,
+        const Vec2 &anchorA, const Vec2 &anchorB,
+        bool flagHits)
+    {
+        if (a.count() == 0 || b.count() == 0)
+            return {};
+
+        // Bucket the smaller group, query with the larger one
+        const bool gridOnB = b.count() <= a.count();
+        InkSprites &query = gridOnB ? a : b;
+        const Vec2 &queryAnchor = gridOnB ? anchorA : anchorB;
+        const bool sameGroup = &a == &b;
+
+        buildBoxGrid(gridOnB ? b : a, gridOnB ? anchorB : anchorA, _boxGrid);
+
+        const ChunkedSoA &data = query.data();
+        const size_t blocks = data.blockCount();
+        prepareRanges(blocks);
+
+        jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                          {
+            double x0[ChunkedSoA::BLOCK_SIZE], y0[ChunkedSoA::BLOCK_SIZE];
+            double w[ChunkedSoA::BLOCK_SIZE], h[ChunkedSoA::BLOCK_SIZE];
+
+            for (size_t blk = begin; blk < end; blk++)
+            {
+                std::vector<uint32_t> &out = _rangePairs[blk];
+                computeBoxes(query, queryAnchor, blk, x0, y0, w, h);
+
+                const uint32_t base = static_cast<uint32_t>(blk * ChunkedSoA::BLOCK_SIZE);
+                const size_t n = data.blockSize(blk);
+                for (size_t i = 0; i < n; i++)
+                {
+                    const uint32_t q = base + static_cast<uint32_t>(i);
+                    forEachOverlap(_boxGrid, x0[i], y0[i], x0[i] + w[i], y0[i] + h[i],
+                                   [&](uint32_t g)
+                                   {
+                                       if (sameGroup && g <= q)
+                                           return;
+                                       out.push_back(gridOnB ? q : g);
+                                       out.push_back(gridOnB ? g : q);
+                                   });
+                }
+            } });
+
+        std::vector<uint32_t> pairs = gatherRanges(blocks);
+
+        if (flagHits)
+        {
+            for (size_t i = 0; i < pairs.size(); i += 2)
+            {
+                a.markHit(pairs[i]);
+                b.markHit(pairs[i + 1]);
+            }
+        }
+
+        return pairs;
+    }
+
+    std::vector<uint32_t> rectPairs(
+        InkSprites &sprites, const std::vector<Rect> &rects,
+        const Vec2 &anchor, bool flagHits)
+    {
+        if (sprites.count() == 0 || rects.empty())
+            return {};
+
+        buildBoxGrid(sprites, anchor, _boxGrid);
+
+        constexpr size_t RECTS_PER_RANGE = 16;
+        const size_t ranges = (rects.size() + RECTS_PER_RANGE - 1) / RECTS_PER_RANGE;
+        prepareRanges(ranges);
+
+        jobs::parallelFor(rects.size(), RECTS_PER_RANGE, [&](size_t begin, size_t end)
+                          {
+            std::vector<uint32_t> &out = _rangePairs[begin / RECTS_PER_RANGE];
+            for (size_t r = begin; r < end; r++)
+            {
+                const Rect &rect = rects[r];
+                forEachOverlap(_boxGrid, rect.x, rect.y, rect.x + rect.w, rect.y + rect.h,
+                               [&](uint32_t s)
+                               {
+                                   out.push_back(s);
+                                   out.push_back(static_cast<uint32_t>(r));
+                               });
+            } });
+
+        std::vector<uint32_t> pairs = gatherRanges(ranges);
+
+        if (flagHits)
+        {
+            for (size_t i = 0; i < pairs.size(); i += 2)
+                sprites.markHit(pairs[i]);
+        }
+
+        return pairs;
+    }
+}
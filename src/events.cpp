@@ -1,20 +1,48 @@
 #include "Events.hpp"
 
 #include <SDL3/SDL.h>
+#include "Renderer.hpp"
 #include "Window.hpp"
 
 namespace events
 {
     static bool _shouldQuit = false;
+    static bool _coalesceMotion = false;
+
+    // Reused by every poll; only grows
+    static std::vector<EventRecord> _records;
 
     bool shouldQuit()
     {
         return _shouldQuit;
     }
 
-    std::vector<Event> pollEvents()
+    void setMotionCoalescing(bool enabled)
     {
-        std::vector<Event> result;
+        _coalesceMotion = enabled;
+    }
+
+    bool getMotionCoalescing()
+    {
+        return _coalesceMotion;
+    }
+
+    static void push(EventType type, float x, float y, int32_t key, int32_t button)
+    {
+        const int32_t id = static_cast<int32_t>(type);
+        if (_coalesceMotion && type == EventType::MOUSE_MOTION &&
+            !_records.empty() && _records.back().type == id)
+        {
+            _records.back().x = x;
+            _records.back().y = y;
+            return;
+        }
+        _records.push_back({id, x, y, key, button});
+    }
+
+    const std::vector<EventRecord> &pollRecords()
+    {
+        _records.clear();
         SDL_Event event;
 
         while (SDL_PollEvent(&event))
@@ -24,49 +52,74 @@ namespace events
             case SDL_EVENT_QUIT:
                 _shouldQuit = true;
                 window::close();
-                result.push_back(QuitEvent{EventType::QUIT});
+                push(EventType::QUIT, 0.0f, 0.0f, 0, 0);
                 break;
 
             case SDL_EVENT_KEY_DOWN:
-            {
-                result.push_back(KeyEvent{EventType::KEY_DOWN, static_cast<int>(event.key.key)});
+                push(EventType::KEY_DOWN, 0.0f, 0.0f, static_cast<int32_t>(event.key.key), 0);
                 break;
-            }
 
             case SDL_EVENT_KEY_UP:
-            {
-                result.push_back(KeyEvent{EventType::KEY_UP, static_cast<int>(event.key.key)});
+                push(EventType::KEY_UP, 0.0f, 0.0f, static_cast<int32_t>(event.key.key), 0);
                 break;
-            }
 
             case SDL_EVENT_MOUSE_BUTTON_DOWN:
-            {
-                result.push_back(MouseEvent{
-                    EventType::MOUSE_DOWN,
-                    static_cast<float>(event.button.x),
-                    static_cast<float>(event.button.y),
-                    static_cast<int>(event.button.button)});
+                push(EventType::MOUSE_DOWN, event.button.x, event.button.y, 0, event.button.button);
                 break;
-            }
 
             case SDL_EVENT_MOUSE_BUTTON_UP:
-            {
-                result.push_back(MouseEvent{
-                    EventType::MOUSE_UP,
-                    static_cast<float>(event.button.x),
-                    static_cast<float>(event.button.y),
-                    static_cast<int>(event.button.button)});
+                push(EventType::MOUSE_UP, event.button.x, event.button.y, 0, event.button.button);
                 break;
-            }
 
             case SDL_EVENT_MOUSE_MOTION:
-            {
-                result.push_back(MotionEvent{
-                    EventType::MOUSE_MOTION,
-                    static_cast<float>(event.motion.x),
-                    static_cast<float>(event.motion.y)});
+                push(EventType::MOUSE_MOTION, event.motion.x, event.motion.y, 0, 0);
+                break;
+
+            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED:
+                renderer::_view_changed();
+                break;
+
+            case SDL_EVENT_RENDER_TARGETS_RESET:
+            case SDL_EVENT_RENDER_DEVICE_RESET:
+                renderer::_targets_lost();
+                break;
+
+            default:
                 break;
             }
+        }
+
+        return _records;
+    }
+
+    std::vector<Event> pollEvents()
+    {
+        const std::vector<EventRecord> &records = pollRecords();
+        std::vector<Event> result;
+        result.reserve(records.size());
+
+        for (const EventRecord &record : records)
+        {
+            const EventType type = static_cast<EventType>(record.type);
+            switch (type)
+            {
+            case EventType::KEY_DOWN:
+            case EventType::KEY_UP:
+                result.push_back(KeyEvent{type, record.key});
+                break;
+
+            case EventType::MOUSE_DOWN:
+            case EventType::MOUSE_UP:
+                result.push_back(MouseEvent{type, record.x, record.y, record.button});
+                break;
+
+            case EventType::MOUSE_MOTION:
+                result.push_back(MotionEvent{type, record.x, record.y});
+                break;
+
+            case EventType::QUIT:
+                result.push_back(QuitEvent{type});
+                break;
 
             default:
                 break;
@@ -3,21 +3,95 @@
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/variant.h>
 #include <nanobind/operators.h>
+#include <nanobind/ndarray.h>
 
 #include "Events.hpp"
 #include "Window.hpp"
 #include "Renderer.hpp"
 #include "Texture.hpp"
+#include "TextureAtlas.hpp"
+#include "AssetPack.hpp"
+#include "TextureCache.hpp"
+#include "CachedLayer.hpp"
+#include "Capture.hpp"
+#include "Tilemap.hpp"
+#include "TiledTexture.hpp"
 #include "Time.hpp"
 #include "Vec2.hpp"
 #include "Color.hpp"
 #include "Transform.hpp"
+#include "Camera.hpp"
 #include "Rect.hpp"
 #include "InkSprites.hpp"
+#include "Jobs.hpp"
+#include "Collision.hpp"
 
 namespace nb = nanobind;
 using namespace nb::literals;
 
+template <typename T>
+using NumpyArray = nb::ndarray<nb::numpy, T, nb::ndim<1>>;
+
+template <typename T>
+using CpuArray = nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu>;
+
+// Hand a vector over to NumPy without copying; the capsule owns the storage.
+template <typename T>
+static NumpyArray<T> toNumpy(std::vector<T> &&values)
+{
+    auto *owned = new std::vector<T>(std::move(values));
+    nb::capsule owner(owned, [](void *p) noexcept
+                      { delete static_cast<std::vector<T> *>(p); });
+    return NumpyArray<T>(owned->data(), {owned->size()}, owner);
+}
+
+// Flattened [a0, b0, a1, b1, ...] pairs as an (N, 2) array
+static nb::ndarray<nb::numpy, uint32_t, nb::ndim<2>> toNumpyPairs(std::vector<uint32_t> &&pairs)
+{
+    auto *owned = new std::vector<uint32_t>(std::move(pairs));
+    nb::capsule owner(owned, [](void *p) noexcept
+                      { delete static_cast<std::vector<uint32_t> *>(p); });
+    return nb::ndarray<nb::numpy, uint32_t, nb::ndim<2>>(owned->data(), {owned->size() / 2, 2}, owner);
+}
+
+// FrameStats rows as an (N, 9) array; the struct is nothing but uint64s
+static nb::ndarray<nb::numpy, uint64_t, nb::ndim<2>> toNumpyStats(std::vector<renderer::FrameStats> &&frames)
+{
+    constexpr size_t FIELDS = sizeof(renderer::FrameStats) / sizeof(uint64_t);
+    static_assert(sizeof(renderer::FrameStats) == FIELDS * sizeof(uint64_t));
+
+    auto *owned = new std::vector<renderer::FrameStats>(std::move(frames));
+    nb::capsule owner(owned, [](void *p) noexcept
+                      { delete static_cast<std::vector<renderer::FrameStats> *>(p); });
+    return nb::ndarray<nb::numpy, uint64_t, nb::ndim<2>>(
+        reinterpret_cast<uint64_t *>(owned->data()), {owned->size(), FIELDS}, owner);
+}
+
+// Event records as a structured array; the dtype mirrors EventRecord
+static nb::object toNumpyEvents(const std::vector<events::EventRecord> &records)
+{
+    static_assert(sizeof(events::EventRecord) == 20, "EventRecord layout changed");
+
+    // Built once and kept for the life of the interpreter
+    static nb::object *dtype = []
+    {
+        nb::list fields;
+        fields.append(nb::make_tuple("type", "<i4"));
+        fields.append(nb::make_tuple("x", "<f4"));
+        fields.append(nb::make_tuple("y", "<f4"));
+        fields.append(nb::make_tuple("key", "<i4"));
+        fields.append(nb::make_tuple("button", "<i4"));
+        return new nb::object(nb::module_::import_("numpy").attr("dtype")(fields));
+    }();
+
+    auto *owned = new std::vector<events::EventRecord>(records);
+    nb::capsule owner(owned, [](void *p) noexcept
+                      { delete static_cast<std::vector<events::EventRecord> *>(p); });
+    nb::ndarray<nb::numpy, uint8_t, nb::ndim<1>> bytes(
+        reinterpret_cast<uint8_t *>(owned->data()), {owned->size() * sizeof(events::EventRecord)}, owner);
+    return nb::cast(bytes).attr("view")(*dtype);
+}
+
 void init()
 {
     if (!SDL_Init(SDL_INIT_VIDEO))
@@ -26,7 +100,10 @@ void init()
 
 void quit()
 {
-    // Clean up in reverse order: renderer -> window -> SDL
+    // Clean up in reverse order: workers -> texture loads -> capture -> renderer -> window -> SDL
+    jobs::_quit();
+    textures::_quit();
+    capture::_quit();
     renderer::_quit();
     window::_quit();
     if (SDL_WasInit(0))
@@ -64,6 +141,12 @@ NB_MODULE(goob, m)
         .def_rw("type", &events::QuitEvent::type);
 
     m.def("poll_events", &events::pollEvents, "Poll SDL events and return list of event objects");
+    m.def("poll_events_array", []
+          { return toNumpyEvents(events::pollRecords()); },
+          "Poll SDL events into one NumPy structured array with fields type, x, y, key and button");
+    m.def("set_motion_coalescing", &events::setMotionCoalescing, "enabled"_a,
+          "Merge consecutive mouse motion events into the last one");
+    m.def("get_motion_coalescing", &events::getMotionCoalescing);
     m.def("should_quit", &events::shouldQuit, "Check if quit was requested");
 
     // ========== Vec2 ==========
@@ -120,6 +203,13 @@ NB_MODULE(goob, m)
         .def_rw("rot", &Transform::rot)
         .def_rw("scale", &Transform::scale);
 
+    // ========== Camera ==========
+    nb::class_<Camera>(m, "Camera")
+        .def(nb::init<>())
+        .def_rw("pos", &Camera::pos)
+        .def_rw("zoom", &Camera::zoom)
+        .def_rw("rot", &Camera::rot);
+
     // ========== Texture ==========
     nb::class_<Texture>(m, "Texture")
         .def(nb::init<const std::string &>())
@@ -128,10 +218,54 @@ NB_MODULE(goob, m)
         .def("get_size", &Texture::getSize)
         .def("get_clip_area", &Texture::getClipArea)
         .def("set_clip_area", &Texture::setClipArea)
+        .def("set_frame_grid", &Texture::setFrameGrid, "columns"_a, "rows"_a, "count"_a = 0)
+        .def("set_frames", &Texture::setFrames, "frames"_a)
+        .def("get_frames", &Texture::getFrames)
+        .def("get_frame_count", &Texture::getFrameCount)
+        .def("set_frame", &Texture::setFrame, "index"_a)
         .def("get_alpha", &Texture::getAlpha)
         .def("set_alpha", &Texture::setAlpha)
+        .def("get_blend_mode", &Texture::getBlendMode)
+        .def("set_blend_mode", &Texture::setBlendMode, "mode"_a)
         .def_rw("flip", &Texture::flip);
 
+    nb::class_<textures::Request>(m, "TextureRequest")
+        .def("get_path", &textures::Request::getPath)
+        .def("is_done", &textures::Request::isDone)
+        .def("has_failed", &textures::Request::hasFailed)
+        .def("get_error", &textures::Request::getError)
+        .def("get", &textures::Request::get);
+
+    m.def("load_texture_async", &textures::loadAsync, "path"_a);
+    m.def("set_texture_upload_budget", &textures::setUploadBudget, "milliseconds"_a);
+    m.def("get_texture_upload_budget", &textures::getUploadBudget);
+
+    nb::class_<AssetPack>(m, "AssetPack")
+        .def(nb::init<const std::string &>(), "path"_a)
+        .def_static("build", &AssetPack::build, "out_path"_a, "files"_a, "root"_a = "")
+        .def("contains", &AssetPack::contains, "name"_a)
+        .def("get_names", &AssetPack::getNames)
+        .def("get_texture", &AssetPack::getTexture, "name"_a)
+        .def("get_script", &AssetPack::getScript, "name"_a)
+        .def("size", &AssetPack::size);
+
+    nb::class_<TextureAtlas>(m, "TextureAtlas")
+        .def(nb::init<const std::vector<std::string> &, int, int, const std::string &>(),
+             "paths"_a, "page_size"_a = 2048, "padding"_a = 1, "cache_path"_a = "")
+        .def("get", &TextureAtlas::get, "path"_a)
+        .def("contains", &TextureAtlas::contains, "path"_a)
+        .def("get_paths", &TextureAtlas::getPaths)
+        .def("page_count", &TextureAtlas::pageCount)
+        .def("is_from_cache", &TextureAtlas::isFromCache);
+
+    nb::enum_<Texture::BlendMode>(m, "BlendMode")
+        .value("NONE", Texture::BlendMode::NONE)
+        .value("BLEND", Texture::BlendMode::BLEND)
+        .value("ADD", Texture::BlendMode::ADD)
+        .value("MOD", Texture::BlendMode::MOD)
+        .value("MUL", Texture::BlendMode::MUL)
+        .value("PREMULTIPLIED", Texture::BlendMode::PREMULTIPLIED);
+
     nb::class_<Texture::Flip>(m, "TextureFlip")
         .def(nb::init<>())
         .def_rw("h", &Texture::Flip::h)
@@ -141,11 +275,85 @@ NB_MODULE(goob, m)
     m.def("create_window", &window::create, "title"_a, "width"_a, "height"_a);
     m.def("window_is_open", &window::isOpen);
     m.def("close_window", &window::close);
+    m.def("set_headless", &window::setHeadless, "enabled"_a,
+          "Render offscreen with the software renderer; call before init()");
+    m.def("is_headless", &window::isHeadless);
 
     // ========== Renderer ==========
+    nb::class_<renderer::FrameStats>(m, "FrameStats")
+        .def_ro("frame", &renderer::FrameStats::frame)
+        .def_ro("draw_calls", &renderer::FrameStats::drawCalls)
+        .def_ro("sprites", &renderer::FrameStats::sprites)
+        .def_ro("culled", &renderer::FrameStats::culled)
+        .def_ro("vertices", &renderer::FrameStats::vertices)
+        .def_ro("texture_binds", &renderer::FrameStats::textureBinds)
+        .def_ro("target_switches", &renderer::FrameStats::targetSwitches)
+        .def_ro("state_calls", &renderer::FrameStats::stateCalls)
+        .def_ro("state_calls_skipped", &renderer::FrameStats::stateCallsSkipped);
+
     m.def("clear", nb::overload_cast<const Color &>(&renderer::clear), "color"_a = Color{0, 0, 0, 255});
     m.def("present", &renderer::present);
-    m.def("draw", &renderer::draw, "texture"_a, "transform"_a, "anchor"_a = Vec2{}, "pivot"_a = Vec2{});
+    m.def("draw", &renderer::draw, "texture"_a, "transform"_a, "anchor"_a = Vec2{}, "pivot"_a = Vec2{}, "layer"_a = 0);
+    m.def("flush", &renderer::flush);
+    m.def("set_strict_order", &renderer::set_strict_order, "enabled"_a);
+    m.def("get_strict_order", &renderer::get_strict_order);
+    m.def("set_camera", &renderer::set_camera, "camera"_a);
+    m.def("get_camera", &renderer::get_camera);
+    m.def("world_to_screen", &renderer::world_to_screen, "point"_a);
+    m.def("screen_to_world", &renderer::screen_to_world, "point"_a);
+    m.def("set_culling", &renderer::set_culling, "enabled"_a);
+    m.def("get_culling", &renderer::get_culling);
+    m.def("read_pixels", []
+          {
+              int width = 0, height = 0;
+              auto *owned = new std::vector<uint8_t>(renderer::read_pixels(width, height));
+              nb::capsule owner(owned, [](void *p) noexcept
+                                { delete static_cast<std::vector<uint8_t> *>(p); });
+              return nb::ndarray<nb::numpy, uint8_t, nb::ndim<3>>(
+                  owned->data(), {static_cast<size_t>(height), static_cast<size_t>(width), 4}, owner); },
+          "The frame drawn so far as a (height, width, 4) RGBA uint8 array; call before present()");
+    m.def("get_frame_stats", &renderer::get_frame_stats,
+          "Renderer counters for the last presented frame");
+    m.def("get_stats_history", []
+          { return toNumpyStats(renderer::get_stats_history()); },
+          "Counters of recent frames as an (N, 9) uint64 array, oldest first, "
+          "with columns in FrameStats field order");
+    m.def("set_stats_history", &renderer::set_stats_history, "frames"_a);
+    m.def("get_stats_history_size", &renderer::get_stats_history_size);
+
+    // ========== Capture ==========
+    nb::enum_<capture::Format>(m, "CaptureFormat")
+        .value("RAW", capture::Format::RAW)
+        .value("PNG", capture::Format::PNG)
+        .value("Y4M", capture::Format::Y4M);
+
+    nb::enum_<capture::QueuePolicy>(m, "CaptureQueuePolicy")
+        .value("DROP", capture::QueuePolicy::DROP)
+        .value("BLOCK", capture::QueuePolicy::BLOCK);
+
+    nb::class_<capture::Stats>(m, "CaptureStats")
+        .def_ro("captured", &capture::Stats::captured)
+        .def_ro("written", &capture::Stats::written)
+        .def_ro("dropped", &capture::Stats::dropped)
+        .def_ro("failed", &capture::Stats::failed)
+        .def_ro("queued", &capture::Stats::queued)
+        .def_ro("bytes_written", &capture::Stats::bytesWritten)
+        .def_ro("written_per_second", &capture::Stats::writtenPerSecond)
+        .def_ro("render_ms", &capture::Stats::renderMs)
+        .def_ro("encode_ms", &capture::Stats::encodeMs)
+        .def_ro("error", &capture::Stats::error);
+
+    m.def("start_capture", &capture::start,
+          "path"_a, "format"_a = capture::Format::PNG, "frame_limit"_a = 0,
+          "queue_size"_a = 8, "policy"_a = capture::QueuePolicy::DROP, "fps"_a = 60,
+          "Capture presented frames to path, written on a background thread");
+    m.def("screenshot", &capture::screenshot, "path"_a,
+          "Save the next presented frame as a PNG");
+    m.def("stop_capture", &capture::stop);
+    m.def("is_capturing", &capture::isActive);
+    m.def("wait_capture", &capture::wait, nb::call_guard<nb::gil_scoped_release>(),
+          "Block until every captured frame has been written");
+    m.def("get_capture_stats", &capture::getStats);
 
     // ========== Time ==========
     m.def("get_delta", &gtime::getDelta);
@@ -160,9 +368,128 @@ NB_MODULE(goob, m)
         .def(nb::init<Texture *, const Rect &, const std::string &>(),
              "texture"_a, "bounds"_a, "script_path"_a,
              nb::keep_alive<1, 2>())
-        .def("add", &InkSprites::add, "count"_a, "scale"_a = 1.0)
+        .def_static("from_source", [](Texture *texture, const Rect &bounds, const std::string &source)
+                    { return new InkSprites(texture, bounds, InkSprites::Script{source}); },
+                    "texture"_a, "bounds"_a, "source"_a,
+                    nb::rv_policy::take_ownership, nb::keep_alive<0, 1>())
+        .def("add", [](InkSprites &self, int count, double scale)
+             { return toNumpy(self.add(count, scale)); }, "count"_a, "scale"_a = 1.0,
+             "Add sprites and return their handles as a uint64 array")
         .def("remove", &InkSprites::remove, "count"_a = 1)
+        .def("remove_handle", &InkSprites::removeHandle, "handle"_a)
+        .def("remove_handles", [](InkSprites &self, CpuArray<uint64_t> handles)
+             { return self.removeHandles(handles.data(), handles.shape(0)); }, "handles"_a)
+        .def("is_alive", &InkSprites::isAlive, "handle"_a)
+        .def("index_of", &InkSprites::indexOf, "handle"_a)
+        .def("handle_at", &InkSprites::handleAt, "index"_a)
+        .def("enable_spatial_index", &InkSprites::enableSpatialIndex,
+             "cell_size"_a, "neighbor_radius"_a = 0.0)
+        .def("disable_spatial_index", &InkSprites::disableSpatialIndex)
+        .def("query_radius", [](InkSprites &self, const Vec2 &center, double radius)
+             { return toNumpy(self.queryRadius(center, radius)); }, "center"_a, "radius"_a,
+             "Indices of sprites within radius of center")
+        .def("query_rect", [](InkSprites &self, const Rect &rect)
+             { return toNumpy(self.queryRect(rect)); }, "rect"_a,
+             "Indices of sprites whose position lies inside rect")
         .def("count", &InkSprites::count)
         .def("update", &InkSprites::update, "dt"_a)
-        .def("render", &InkSprites::render, "anchor"_a = Vec2{}, "pivot"_a = Vec2{});
+        .def("render", &InkSprites::render, "anchor"_a = Vec2{}, "pivot"_a = Vec2{})
+        .def("set_fused", &InkSprites::setFused,
+             "enabled"_a, "anchor"_a = Vec2{}, "pivot"_a = Vec2{})
+        .def("is_fused", &InkSprites::isFused)
+        .def("get_version", &InkSprites::getVersion)
+        .def("set_render_mode", &InkSprites::setRenderMode, "mode"_a)
+        .def("get_render_mode", &InkSprites::getRenderMode)
+        .def("set_lod_threshold", &InkSprites::setLodThreshold, "pixels"_a)
+        .def("get_lod_threshold", &InkSprites::getLodThreshold)
+        .def("set_point_size", &InkSprites::setPointSize, "pixels"_a)
+        .def("get_point_size", &InkSprites::getPointSize)
+        .def("set_point_color", &InkSprites::setPointColor, "color"_a)
+        .def("get_point_color", &InkSprites::getPointColor)
+        .def("set_density_cell_size", &InkSprites::setDensityCellSize, "pixels"_a)
+        .def("get_density_cell_size", &InkSprites::getDensityCellSize);
+
+    nb::enum_<InkSprites::RenderMode>(m, "RenderMode")
+        .value("SPRITES", InkSprites::RenderMode::SPRITES)
+        .value("POINTS", InkSprites::RenderMode::POINTS)
+        .value("DENSITY", InkSprites::RenderMode::DENSITY);
+
+    // ========== CachedLayer ==========
+    nb::class_<CachedLayer>(m, "CachedLayer")
+        .def(nb::init<int, int>(), "width"_a, "height"_a)
+        .def("begin", &CachedLayer::begin)
+        .def("end", &CachedLayer::end)
+        .def("is_recording", &CachedLayer::isRecording)
+        .def("is_dirty", &CachedLayer::isDirty)
+        .def("mark_dirty", &CachedLayer::markDirty)
+        .def("update", &CachedLayer::update, "sprites"_a, "anchor"_a = Vec2{}, "pivot"_a = Vec2{})
+        .def("draw", &CachedLayer::draw,
+             "transform"_a = Transform{}, "anchor"_a = Vec2{}, "pivot"_a = Vec2{}, "layer"_a = 0)
+        .def("get_texture", &CachedLayer::getTexture, nb::rv_policy::reference_internal)
+        .def("get_width", &CachedLayer::getWidth)
+        .def("get_height", &CachedLayer::getHeight);
+
+    // ========== Tilemap ==========
+    nb::class_<Tilemap>(m, "Tilemap")
+        .def(nb::init<Texture *, int, int, int, int, int>(),
+             "tileset"_a, "columns"_a, "rows"_a, "tile_width"_a, "tile_height"_a, "chunk_size"_a = 32,
+             nb::keep_alive<1, 2>())
+        .def("get_columns", &Tilemap::getColumns)
+        .def("get_rows", &Tilemap::getRows)
+        .def("get_tile_width", &Tilemap::getTileWidth)
+        .def("get_tile_height", &Tilemap::getTileHeight)
+        .def("get_chunk_size", &Tilemap::getChunkSize)
+        .def("get_tile", &Tilemap::getTile, "column"_a, "row"_a)
+        .def("set_tile", &Tilemap::setTile, "column"_a, "row"_a, "id"_a)
+        .def("set_tiles", [](Tilemap &self, nb::ndarray<const int32_t, nb::ndim<2>, nb::c_contig, nb::device::cpu> ids)
+             { self.setTiles(ids.data(), ids.shape(0), ids.shape(1)); }, "ids"_a,
+             "Replace every tile from an int32 array of shape (rows, columns)")
+        .def("get_tiles", [](Tilemap &self)
+             { return nb::ndarray<nb::numpy, const int32_t, nb::ndim<2>>(
+                   self.getTiles().data(),
+                   {static_cast<size_t>(self.getRows()), static_cast<size_t>(self.getColumns())},
+                   nb::handle()); }, nb::rv_policy::reference_internal,
+             "Read-only (rows, columns) view of the tiles; use set_tile/set_tiles to change them")
+        .def("fill", &Tilemap::fill, "id"_a)
+        .def("get_position", &Tilemap::getPosition)
+        .def("set_position", &Tilemap::setPosition, "position"_a)
+        .def("render", &Tilemap::render)
+        .def("built_chunk_count", &Tilemap::builtChunkCount)
+        .def("drawn_chunk_count", &Tilemap::drawnChunkCount);
+
+    // ========== TiledTexture ==========
+    nb::class_<TiledTexture>(m, "TiledTexture")
+        .def(nb::init<const std::string &, int>(), "png_path"_a, "tile_size"_a = 1024)
+        .def_static("from_pack", [](AssetPack &pack, const std::string &name, int tileSize)
+                    { return new TiledTexture(pack, name, tileSize); },
+                    "pack"_a, "name"_a, "tile_size"_a = 1024,
+                    nb::rv_policy::take_ownership, nb::keep_alive<0, 1>())
+        .def("get_width", &TiledTexture::getWidth)
+        .def("get_height", &TiledTexture::getHeight)
+        .def("get_tile_size", &TiledTexture::getTileSize)
+        .def("get_tile_count", &TiledTexture::getTileCount)
+        .def("get_position", &TiledTexture::getPosition)
+        .def("set_position", &TiledTexture::setPosition, "position"_a)
+        .def("get_scale", &TiledTexture::getScale)
+        .def("set_scale", &TiledTexture::setScale, "scale"_a)
+        .def("get_alpha", &TiledTexture::getAlpha)
+        .def("set_alpha", &TiledTexture::setAlpha, "alpha"_a)
+        .def("get_budget", &TiledTexture::getBudget)
+        .def("set_budget", &TiledTexture::setBudget, "bytes"_a)
+        .def("get_resident_bytes", &TiledTexture::getResidentBytes)
+        .def("get_resident_tiles", &TiledTexture::getResidentTiles)
+        .def("get_uploads", &TiledTexture::getUploads)
+        .def("get_last_uploads", &TiledTexture::getLastUploads)
+        .def("render", &TiledTexture::render)
+        .def("evict_all", &TiledTexture::evictAll);
+
+    // ========== Collision ==========
+    m.def("collide", [](InkSprites &a, InkSprites &b, const Vec2 &anchorA, const Vec2 &anchorB, bool flagHits)
+          { return toNumpyPairs(collision::spritePairs(a, b, anchorA, anchorB, flagHits)); },
+          "a"_a, "b"_a, "anchor_a"_a = Vec2{}, "anchor_b"_a = Vec2{}, "flag_hits"_a = false,
+          "Overlapping (index in a, index in b) pairs as an (N, 2) uint32 array");
+    m.def("collide_rects", [](InkSprites &sprites, const std::vector<Rect> &rects, const Vec2 &anchor, bool flagHits)
+          { return toNumpyPairs(collision::rectPairs(sprites, rects, anchor, flagHits)); },
+          "sprites"_a, "rects"_a, "anchor"_a = Vec2{}, "flag_hits"_a = false,
+          "Overlapping (sprite index, rect index) pairs as an (N, 2) uint32 array");
 }
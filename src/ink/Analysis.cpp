@@ -0,0 +1,94 @@
+#include "ink/Analysis.hpp"
+
+namespace ink
+{
+
+    bool FieldUsage::readsPrefix(const std::string &prefix) const
+    {
+        for (const auto &name : read)
+        {
+            if (name.compare(0, prefix.size(), prefix) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool FieldUsage::writesPrefix(const std::string &prefix) const
+    {
+        for (const auto &name : written)
+        {
+            if (name.compare(0, prefix.size(), prefix) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    static void collectExpr(const Expr &expr, FieldUsage &usage)
+    {
+        switch (expr.kind)
+        {
+        case ExprKind::NUMBER:
+            break;
+        case ExprKind::FIELD:
+            usage.read.insert(static_cast<const FieldAccess &>(expr).fullName());
+            break;
+        case ExprKind::BINARY:
+        {
+            auto &bin = static_cast<const BinaryExpr &>(expr);
+            collectExpr(*bin.left, usage);
+            collectExpr(*bin.right, usage);
+            break;
+        }
+        case ExprKind::UNARY:
+            collectExpr(*static_cast<const UnaryExpr &>(expr).operand, usage);
+            break;
+        }
+    }
+
+    static void collectBlock(const Block &block, FieldUsage &usage)
+    {
+        for (const auto &stmt : block.stmts)
+        {
+            switch (stmt->kind)
+            {
+            case StmtKind::IF:
+            {
+                auto &ifStmt = static_cast<const IfStmt &>(*stmt);
+                for (const auto &branch : ifStmt.branches)
+                {
+                    collectExpr(*branch.condition, usage);
+                    collectBlock(*branch.body, usage);
+                }
+                if (ifStmt.elseBranch)
+                    collectBlock(*ifStmt.elseBranch, usage);
+                break;
+            }
+            case StmtKind::ASSIGN:
+            {
+                auto &assign = static_cast<const AssignStmt &>(*stmt);
+                usage.written.insert(assign.target);
+                collectExpr(*assign.value, usage);
+                break;
+            }
+            case StmtKind::COMPOUND_ASSIGN:
+            {
+                // `x += v` reads x as well as writing it
+                auto &assign = static_cast<const CompoundAssignStmt &>(*stmt);
+                usage.written.insert(assign.target);
+                usage.read.insert(assign.target);
+                collectExpr(*assign.value, usage);
+                break;
+            }
+            }
+        }
+    }
+
+    FieldUsage analyzeFields(const BehaviorDecl &behavior)
+    {
+        FieldUsage usage;
+        if (behavior.body)
+            collectBlock(*behavior.body, usage);
+        return usage;
+    }
+
+} // namespace ink
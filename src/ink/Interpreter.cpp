@@ -1,6 +1,7 @@
 #include "ink/Interpreter.hpp"
 
 #include <cmath>
+#include <algorithm>
 #include <stdexcept>
 
 #ifndef M_PI
@@ -15,6 +16,16 @@ namespace ink
         m_fields[name] = data;
     }
 
+    void Interpreter::bindReadOnlyField(const std::string &name, const double *data)
+    {
+        m_readOnly[name] = {data};
+    }
+
+    void Interpreter::bindScaledField(const std::string &name, double *data, const double *source, double factor)
+    {
+        m_readOnly[name] = {data, data, source, factor, false};
+    }
+
     void Interpreter::setConstant(const std::string &name, double value)
     {
         m_constants[name] = value;
@@ -31,9 +42,27 @@ namespace ink
             return;
         m_activeMask.assign(m_count, 1.0);
         m_maskStack.clear();
+        m_written.clear();
         execBlock(*behavior.body);
     }
 
+    bool Interpreter::wasWritten(const double *field) const
+    {
+        return std::find(m_written.begin(), m_written.end(), field) != m_written.end();
+    }
+
+    void Interpreter::recordWrite(const double *field)
+    {
+        if (!wasWritten(field))
+            m_written.push_back(field);
+
+        for (auto &[name, readOnly] : m_readOnly)
+        {
+            if (readOnly.source == field)
+                readOnly.stale = true;
+        }
+    }
+
     // ======================== Helpers ========================
 
     static inline double applyBinOp(BinOp op, double l, double r)
@@ -88,11 +117,25 @@ namespace ink
             auto &field = static_cast<const FieldAccess &>(expr);
             std::string name = field.fullName();
 
-            // Check mutable fields first (returns a copy of the array)
+            // Check mutable fields first (borrows the array — no copy)
             auto fit = m_fields.find(name);
             if (fit != m_fields.end())
             {
-                return Value(std::vector<double>(fit->second, fit->second + m_count));
+                return Value(static_cast<const double *>(fit->second));
+            }
+
+            // Read-only fields, refreshed first if their source changed
+            auto rit = m_readOnly.find(name);
+            if (rit != m_readOnly.end())
+            {
+                ReadOnlyField &readOnly = rit->second;
+                if (readOnly.stale)
+                {
+                    for (size_t i = 0; i < m_count; i++)
+                        readOnly.scaled[i] = readOnly.source[i] * readOnly.factor;
+                    readOnly.stale = false;
+                }
+                return Value(readOnly.data);
             }
 
             // Check constants (returns a scalar — no allocation)
@@ -117,34 +160,41 @@ namespace ink
                 return Value(applyBinOp(bin.op, left.scalar, right.scalar));
             }
 
-            // scalar OP vector → reuse right's storage
+            // Operand pointers stay valid when an owned buffer is moved below
+            const double *l = left.data();
+            const double *r = right.data();
+
+            // Write into whichever operand owns its storage; only allocate
+            // when both sides are scalars or borrowed fields.
+            std::vector<double> out;
+            if (left.isOwned())
+                out = std::move(left.vec);
+            else if (right.isOwned())
+                out = std::move(right.vec);
+            else
+                out.resize(m_count);
+
+            // scalar OP vector
             if (left.isScalar)
             {
                 double s = left.scalar;
                 for (size_t i = 0; i < m_count; i++)
-                {
-                    right.vec[i] = applyBinOp(bin.op, s, right.vec[i]);
-                }
-                return right;
+                    out[i] = applyBinOp(bin.op, s, r[i]);
             }
-
-            // vector OP scalar → reuse left's storage
-            if (right.isScalar)
+            // vector OP scalar
+            else if (right.isScalar)
             {
                 double s = right.scalar;
                 for (size_t i = 0; i < m_count; i++)
-                {
-                    left.vec[i] = applyBinOp(bin.op, left.vec[i], s);
-                }
-                return left;
+                    out[i] = applyBinOp(bin.op, l[i], s);
             }
-
-            // vector OP vector → reuse left's storage
-            for (size_t i = 0; i < m_count; i++)
+            // vector OP vector
+            else
             {
-                left.vec[i] = applyBinOp(bin.op, left.vec[i], right.vec[i]);
+                for (size_t i = 0; i < m_count; i++)
+                    out[i] = applyBinOp(bin.op, l[i], r[i]);
             }
-            return left;
+            return Value(std::move(out));
         }
 
         case ExprKind::UNARY:
@@ -152,21 +202,31 @@ namespace ink
             auto &un = static_cast<const UnaryExpr &>(expr);
             Value operand = eval(*un.operand);
 
-            if (un.op == UnaryOp::NEG)
+            if (operand.isScalar)
             {
-                if (operand.isScalar)
+                if (un.op == UnaryOp::NEG)
                     return Value(-operand.scalar);
-                for (size_t i = 0; i < m_count; i++)
-                    operand.vec[i] = -operand.vec[i];
-                return operand;
+                return Value(operand.scalar == 0.0 ? 1.0 : 0.0);
             }
 
-            // NOT
-            if (operand.isScalar)
-                return Value(operand.scalar == 0.0 ? 1.0 : 0.0);
-            for (size_t i = 0; i < m_count; i++)
-                operand.vec[i] = operand.vec[i] == 0.0 ? 1.0 : 0.0;
-            return operand;
+            const double *in = operand.data();
+            std::vector<double> out;
+            if (operand.isOwned())
+                out = std::move(operand.vec);
+            else
+                out.resize(m_count);
+
+            if (un.op == UnaryOp::NEG)
+            {
+                for (size_t i = 0; i < m_count; i++)
+                    out[i] = -in[i];
+            }
+            else // NOT
+            {
+                for (size_t i = 0; i < m_count; i++)
+                    out[i] = in[i] == 0.0 ? 1.0 : 0.0;
+            }
+            return Value(std::move(out));
         }
 
         } // switch
@@ -219,17 +279,26 @@ namespace ink
             }
             else
             {
+                const double *cv = cond.data();
                 for (size_t i = 0; i < m_count; i++)
-                    branchMask[i] = remaining[i] * (cond.vec[i] != 0.0 ? 1.0 : 0.0);
+                    branchMask[i] = remaining[i] * (cv[i] != 0.0 ? 1.0 : 0.0);
             }
 
             // Remove matched sprites from remaining
+            bool anyActive = false;
             for (size_t i = 0; i < m_count; i++)
             {
                 if (branchMask[i] > 0.0)
+                {
                     remaining[i] = 0.0;
+                    anyActive = true;
+                }
             }
 
+            // Nothing to do for a branch no sprite takes
+            if (!anyActive)
+                continue;
+
             // Execute branch body under new mask
             m_maskStack.push_back(std::move(m_activeMask));
             m_activeMask = std::move(branchMask);
@@ -239,7 +308,9 @@ namespace ink
         }
 
         // Optional else branch — uses the remaining mask
-        if (stmt.elseBranch)
+        if (stmt.elseBranch &&
+            std::any_of(remaining.begin(), remaining.end(), [](double m)
+                        { return m > 0.0; }))
         {
             m_maskStack.push_back(std::move(m_activeMask));
             m_activeMask = std::move(remaining);
@@ -249,17 +320,23 @@ namespace ink
         }
     }
 
+    std::unordered_map<std::string, double *>::iterator Interpreter::findAssignable(const std::string &target)
+    {
+        auto it = m_fields.find(target);
+        if (it != m_fields.end())
+            return it;
+        if (m_readOnly.count(target))
+            throw std::runtime_error("Ink: cannot assign to read-only field '" + target + "'");
+        throw std::runtime_error("Ink: cannot assign to unknown field '" + target + "'");
+    }
+
     void Interpreter::execAssign(const AssignStmt &stmt)
     {
-        auto it = m_fields.find(stmt.target);
-        if (it == m_fields.end())
-        {
-            throw std::runtime_error(
-                "Ink: cannot assign to unknown field '" + stmt.target + "'");
-        }
+        auto it = findAssignable(stmt.target);
 
         Value rhs = eval(*stmt.value);
         double *field = it->second;
+        recordWrite(field);
 
         if (rhs.isScalar)
         {
@@ -272,32 +349,31 @@ namespace ink
         }
         else
         {
+            const double *rv = rhs.data();
             for (size_t i = 0; i < m_count; i++)
             {
                 if (m_activeMask[i] > 0.0)
-                    field[i] = rhs.vec[i];
+                    field[i] = rv[i];
             }
         }
     }
 
     void Interpreter::execCompoundAssign(const CompoundAssignStmt &stmt)
     {
-        auto it = m_fields.find(stmt.target);
-        if (it == m_fields.end())
-        {
-            throw std::runtime_error(
-                "Ink: cannot assign to unknown field '" + stmt.target + "'");
-        }
+        auto it = findAssignable(stmt.target);
 
         Value rhs = eval(*stmt.value);
         double *field = it->second;
+        recordWrite(field);
+
+        const double *rvec = rhs.isScalar ? nullptr : rhs.data();
 
         for (size_t i = 0; i < m_count; i++)
         {
             if (m_activeMask[i] <= 0.0)
                 continue;
 
-            double rv = rhs.isScalar ? rhs.scalar : rhs.vec[i];
+            double rv = rvec ? rvec[i] : rhs.scalar;
 
             switch (stmt.op)
             {
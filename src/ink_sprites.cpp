@@ -4,9 +4,11 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 #include "ink/Lexer.hpp"
 #include "ink/Parser.hpp"
+#include "Jobs.hpp"
 #include "Renderer.hpp"
 #include "Texture.hpp"
 
@@ -14,10 +16,8 @@
 #define M_PI 3.14159265358979323846
 #endif
 
-InkSprites::InkSprites(Texture *texture, const Rect &bounds, const std::string &scriptPath)
-    : m_texture(texture), m_bounds(bounds)
+static std::string readScript(const std::string &scriptPath)
 {
-    // Read the .ink script
     std::ifstream file(scriptPath);
     if (!file.is_open())
     {
@@ -26,55 +26,176 @@ InkSprites::InkSprites(Texture *texture, const Rect &bounds, const std::string &
 
     std::stringstream ss;
     ss << file.rdbuf();
-    std::string source = ss.str();
+    return ss.str();
+}
+
+InkSprites::InkSprites(Texture *texture, const Rect &bounds, const std::string &scriptPath)
+    : InkSprites(texture, bounds, Script{readScript(scriptPath)})
+{
+}
 
+InkSprites::InkSprites(Texture *texture, const Rect &bounds, const Script &script)
+    : m_texture(texture), m_bounds(bounds)
+{
     // Lex + parse (done once at construction)
-    ink::Lexer lexer(source);
+    ink::Lexer lexer(script.source);
     auto tokens = lexer.tokenize();
 
     ink::Parser parser(tokens);
     m_behavior = parser.parse();
+    m_usage = ink::analyzeFields(m_behavior);
+
+    m_bindings = {
+        {"pos.x", POS_X},
+        {"pos.y", POS_Y},
+        {"dir.x", DIR_X},
+        {"dir.y", DIR_Y},
+        {"rot", ROT},
+        {"scale.x", SCALE_X},
+        {"scale.y", SCALE_Y},
+        {"speed", SPEED},
+        {"angle_speed", ANGLE_SPEED},
+    };
+
+    // Opt-in columns are only allocated when the script reads them
+    if (m_usage.readsPrefix("neighbors."))
+    {
+        m_colNeighbors = m_data.addColumns(NEIGHBOR_FIELD_COUNT);
+        m_readOnlyBindings.push_back({"neighbors.count", m_colNeighbors + NEIGHBOR_COUNT});
+        m_readOnlyBindings.push_back({"neighbors.dir_x", m_colNeighbors + NEIGHBOR_DIR_X});
+        m_readOnlyBindings.push_back({"neighbors.dir_y", m_colNeighbors + NEIGHBOR_DIR_Y});
+        m_readOnlyBindings.push_back({"neighbors.center_x", m_colNeighbors + NEIGHBOR_CENTER_X});
+        m_readOnlyBindings.push_back({"neighbors.center_y", m_colNeighbors + NEIGHBOR_CENTER_Y});
+    }
+
+    if (m_usage.isRead("rect_w") || m_usage.isRead("rect_h"))
+    {
+        m_colRect = m_data.addColumns(2);
+    }
+
+    if (m_usage.isRead("hit") || m_usage.isWritten("hit"))
+        enableHitField();
+
+    if (m_usage.readsPrefix("color.") || m_usage.writesPrefix("color."))
+        enableColorField();
+
+    if (m_usage.isRead("frame") || m_usage.isWritten("frame"))
+        enableFrameField();
 }
 
-void InkSprites::rebindFields()
+InkSprites::~InkSprites() = default;
+
+void InkSprites::bindBlock(ink::Interpreter &interpreter, size_t block)
 {
-    // Re-bind pointers every frame because vector reallocation
-    // from add()/remove() can invalidate them.
-    m_interpreter.bindField("pos.x", m_pos_x.data());
-    m_interpreter.bindField("pos.y", m_pos_y.data());
-    m_interpreter.bindField("dir.x", m_dir_x.data());
-    m_interpreter.bindField("dir.y", m_dir_y.data());
-    m_interpreter.bindField("rot", m_rot.data());
-    m_interpreter.bindField("scale.x", m_scale_x.data());
-    m_interpreter.bindField("scale.y", m_scale_y.data());
-    m_interpreter.bindField("speed", m_speed.data());
-    m_interpreter.bindField("angle_speed", m_angle_speed.data());
-    m_interpreter.setCount(m_size);
+    // Block pointers are stable across add()/remove(); only the block being
+    // executed changes, so binding is a handful of pointer updates.
+    for (const auto &[name, col] : m_bindings)
+        interpreter.bindField(name, m_data.column(block, col));
+    for (const auto &[name, col] : m_readOnlyBindings)
+        interpreter.bindReadOnlyField(name, m_data.column(block, col));
+
+    // Recomputed by the interpreter when the script assigns to scale.*
+    if (m_colRect != NO_COLUMN)
+    {
+        interpreter.bindScaledField("rect_w", m_data.column(block, m_colRect),
+                                    m_data.column(block, SCALE_X), m_rectClipW);
+        interpreter.bindScaledField("rect_h", m_data.column(block, m_colRect + 1),
+                                    m_data.column(block, SCALE_Y), m_rectClipH);
+    }
+    interpreter.setCount(m_data.blockSize(block));
 }
 
-void InkSprites::add(int count, double scale)
+void InkSprites::buildBlockQuads(size_t block, const renderer::QuadParams &params,
+                                 const renderer::FrameTable &frames, SDL_Vertex *out) const
 {
+    const size_t n = m_data.blockSize(block);
+    if (m_colFrame != NO_COLUMN)
+    {
+        renderer::build_quads(
+            params, frames,
+            m_data.column(block, POS_X), m_data.column(block, POS_Y),
+            m_data.column(block, ROT),
+            m_data.column(block, SCALE_X), m_data.column(block, SCALE_Y),
+            m_data.column(block, m_colFrame),
+            n, out);
+    }
+    else
+    {
+        renderer::build_quads(
+            params,
+            m_data.column(block, POS_X), m_data.column(block, POS_Y),
+            m_data.column(block, ROT),
+            m_data.column(block, SCALE_X), m_data.column(block, SCALE_Y),
+            n, out);
+    }
+
+    if (m_colColor != NO_COLUMN)
+    {
+        renderer::tint_quads(
+            m_data.column(block, m_colColor), m_data.column(block, m_colColor + 1),
+            m_data.column(block, m_colColor + 2), m_data.column(block, m_colColor + 3),
+            n, out);
+    }
+}
+
+void InkSprites::buildVisibleQuads(size_t block, const renderer::QuadParams &params,
+                                   const renderer::FrameTable &frames, size_t visible, SDL_Vertex *out) const
+{
+    const size_t n = m_data.blockSize(block);
+    if (visible == n)
+    {
+        buildBlockQuads(block, params, frames, out);
+        return;
+    }
+
+    const uint32_t *indices = m_visible.data() + block * ChunkedSoA::BLOCK_SIZE;
+    const bool hasFrames = m_colFrame != NO_COLUMN;
+    renderer::build_quads_indexed(
+        params, hasFrames ? &frames : nullptr,
+        m_data.column(block, POS_X), m_data.column(block, POS_Y),
+        m_data.column(block, ROT),
+        m_data.column(block, SCALE_X), m_data.column(block, SCALE_Y),
+        hasFrames ? m_data.column(block, m_colFrame) : nullptr,
+        indices, visible, out);
+
+    if (m_colColor != NO_COLUMN)
+    {
+        // Tint reads per-sprite colors in quad order, so gather them
+        const double *columns[4] = {
+            m_data.column(block, m_colColor), m_data.column(block, m_colColor + 1),
+            m_data.column(block, m_colColor + 2), m_data.column(block, m_colColor + 3)};
+        double gathered[4][ChunkedSoA::BLOCK_SIZE];
+        for (size_t c = 0; c < 4; c++)
+        {
+            for (size_t k = 0; k < visible; k++)
+                gathered[c][k] = columns[c][indices[k]];
+        }
+        renderer::tint_quads(gathered[0], gathered[1], gathered[2], gathered[3], visible, out);
+    }
+}
+
+std::vector<InkSprites::Handle> InkSprites::add(int count, double scale)
+{
+    std::vector<Handle> handles;
+    if (count <= 0)
+        return handles;
+
     std::uniform_real_distribution<double> distX(m_bounds.x, m_bounds.x + m_bounds.w);
     std::uniform_real_distribution<double> distY(m_bounds.y, m_bounds.y + m_bounds.h);
     std::uniform_real_distribution<double> distDir(-1.0, 1.0);
     std::uniform_real_distribution<double> distAngle(0.2, 3.5);
     std::uniform_real_distribution<double> distSpeed(1.0, 7.0);
 
-    size_t newSize = m_size + count;
-    m_pos_x.reserve(newSize);
-    m_pos_y.reserve(newSize);
-    m_dir_x.reserve(newSize);
-    m_dir_y.reserve(newSize);
-    m_rot.reserve(newSize);
-    m_scale_x.reserve(newSize);
-    m_scale_y.reserve(newSize);
-    m_speed.reserve(newSize);
-    m_angle_speed.reserve(newSize);
+    size_t first = m_data.size();
+    m_data.grow(count);
+    handles.reserve(count);
 
-    for (int i = 0; i < count; i++)
+    for (size_t i = first; i < m_data.size(); i++)
     {
-        m_pos_x.push_back(distX(m_rng));
-        m_pos_y.push_back(distY(m_rng));
+        handles.push_back(acquireHandle(static_cast<uint32_t>(i)));
+
+        m_data.at(POS_X, i) = distX(m_rng);
+        m_data.at(POS_Y, i) = distY(m_rng);
 
         double dx = distDir(m_rng);
         double dy = distDir(m_rng);
@@ -85,68 +206,799 @@ void InkSprites::add(int count, double scale)
             dy = 0.0;
             len = 1.0;
         }
-        m_dir_x.push_back(dx / len);
-        m_dir_y.push_back(dy / len);
+        m_data.at(DIR_X, i) = dx / len;
+        m_data.at(DIR_Y, i) = dy / len;
 
-        m_rot.push_back(0.0);
-        m_scale_x.push_back(scale);
-        m_scale_y.push_back(scale);
-        m_speed.push_back(distSpeed(m_rng));
-        m_angle_speed.push_back(distAngle(m_rng));
+        m_data.at(ROT, i) = 0.0;
+        m_data.at(SCALE_X, i) = scale;
+        m_data.at(SCALE_Y, i) = scale;
+        m_data.at(SPEED, i) = distSpeed(m_rng);
+        m_data.at(ANGLE_SPEED, i) = distAngle(m_rng);
+
+        for (const auto &[col, value] : m_columnDefaults)
+            m_data.at(col, i) = value;
     }
 
-    m_size = newSize;
+    markRectsDirty(first, m_data.size() - 1);
+    m_gridStale = true;
+    m_fusedValid = false;
+    m_version++;
+    return handles;
 }
 
 void InkSprites::remove(int count)
 {
-    int toRemove = std::min(count, static_cast<int>(m_size));
-    m_size -= toRemove;
-    m_pos_x.resize(m_size);
-    m_pos_y.resize(m_size);
-    m_dir_x.resize(m_size);
-    m_dir_y.resize(m_size);
-    m_rot.resize(m_size);
-    m_scale_x.resize(m_size);
-    m_scale_y.resize(m_size);
-    m_speed.resize(m_size);
-    m_angle_speed.resize(m_size);
+    if (count <= 0)
+        return;
+
+    size_t toRemove = std::min(static_cast<size_t>(count), m_data.size());
+    for (size_t i = 0; i < toRemove; i++)
+    {
+        releaseHandle(m_dense.back());
+        m_dense.pop_back();
+    }
+    m_data.shrink(toRemove);
+    m_gridStale = true;
+    m_fusedValid = false;
+    m_version++;
+}
+
+bool InkSprites::removeHandle(Handle handle)
+{
+    int64_t index = indexOf(handle);
+    if (index < 0)
+        return false;
+    swapRemove(static_cast<size_t>(index));
+    return true;
+}
+
+size_t InkSprites::removeHandles(const Handle *handles, size_t count)
+{
+    // Each lookup goes through the sparse set, so indices moved by an earlier
+    // swap-remove in the same batch are resolved correctly.
+    size_t removed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (removeHandle(handles[i]))
+            removed++;
+    }
+    return removed;
+}
+
+int64_t InkSprites::indexOf(Handle handle) const
+{
+    uint32_t slot = static_cast<uint32_t>(handle);
+    uint32_t generation = static_cast<uint32_t>(handle >> 32);
+    if (slot >= m_sparse.size() || m_generation[slot] != generation)
+        return -1;
+    return m_sparse[slot];
+}
+
+InkSprites::Handle InkSprites::handleAt(size_t index) const
+{
+    if (index >= m_dense.size())
+        throw std::out_of_range("InkSprites: sprite index out of range");
+    uint32_t slot = m_dense[index];
+    return (static_cast<Handle>(m_generation[slot]) << 32) | slot;
+}
+
+InkSprites::Handle InkSprites::acquireHandle(uint32_t index)
+{
+    uint32_t slot;
+    if (!m_freeSlots.empty())
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<uint32_t>(m_sparse.size());
+        m_sparse.push_back(0);
+        m_generation.push_back(1);
+    }
+
+    m_sparse[slot] = index;
+    m_dense.push_back(slot);
+    return (static_cast<Handle>(m_generation[slot]) << 32) | slot;
+}
+
+void InkSprites::releaseHandle(uint32_t slot)
+{
+    // Bumping the generation invalidates every outstanding copy of the handle.
+    // Generation 0 is skipped so a zeroed handle is never valid.
+    if (++m_generation[slot] == 0)
+        m_generation[slot] = 1;
+    m_freeSlots.push_back(slot);
+}
+
+void InkSprites::swapRemove(size_t index)
+{
+    size_t last = m_data.size() - 1;
+    uint32_t slot = m_dense[index];
+
+    if (index != last)
+    {
+        m_data.copyElement(index, last);
+        markRectsDirty(index, index);
+        m_dense[index] = m_dense[last];
+        m_sparse[m_dense[index]] = static_cast<uint32_t>(index);
+    }
+
+    m_dense.pop_back();
+    m_data.shrink(1);
+    releaseHandle(slot);
+    m_gridStale = true;
+    m_fusedValid = false;
+    m_version++;
+}
+
+void InkSprites::enableSpatialIndex(double cellSize, double neighborRadius)
+{
+    m_grid.configure(m_bounds, cellSize);
+    m_neighborRadius = neighborRadius > 0.0 ? neighborRadius : cellSize;
+    m_gridStale = true;
+}
+
+void InkSprites::disableSpatialIndex()
+{
+    m_grid = SpatialGrid{};
+    m_gridStale = true;
+}
+
+std::vector<uint32_t> InkSprites::queryRadius(const Vec2 &center, double radius)
+{
+    std::vector<uint32_t> result;
+    refreshSpatialIndex();
+    m_grid.queryRadius(center.x, center.y, radius, result);
+    return result;
+}
+
+std::vector<uint32_t> InkSprites::queryRect(const Rect &rect)
+{
+    std::vector<uint32_t> result;
+    refreshSpatialIndex();
+    m_grid.queryRect(rect, result);
+    return result;
+}
+
+void InkSprites::markRectsDirty(size_t first, size_t last)
+{
+    if (m_colRect == NO_COLUMN)
+        return;
+    size_t lastBlock = last / ChunkedSoA::BLOCK_SIZE;
+    if (m_rectDirty.size() <= lastBlock)
+        m_rectDirty.resize(lastBlock + 1, 1);
+    for (size_t b = first / ChunkedSoA::BLOCK_SIZE; b <= lastBlock; b++)
+        m_rectDirty[b] = 1;
+}
+
+void InkSprites::refreshRects(size_t block, const Rect &clip)
+{
+    const double *sx = m_data.column(block, SCALE_X);
+    const double *sy = m_data.column(block, SCALE_Y);
+    double *rw = m_data.column(block, m_colRect);
+    double *rh = m_data.column(block, m_colRect + 1);
+    size_t n = m_data.blockSize(block);
+    for (size_t i = 0; i < n; i++)
+    {
+        rw[i] = clip.w * sx[i];
+        rh[i] = clip.h * sy[i];
+    }
+}
+
+void InkSprites::enableHitField()
+{
+    if (m_colHit != NO_COLUMN)
+        return;
+    m_colHit = m_data.addColumns(1);
+    m_bindings.push_back({"hit", m_colHit});
+    m_columnDefaults.push_back({m_colHit, 0.0});
+}
+
+void InkSprites::enableColorField()
+{
+    if (m_colColor != NO_COLUMN)
+        return;
+    m_colColor = m_data.addColumns(4, 1.0);
+    const char *names[] = {"color.r", "color.g", "color.b", "color.a"};
+    for (size_t c = 0; c < 4; c++)
+    {
+        m_bindings.push_back({names[c], m_colColor + c});
+        m_columnDefaults.push_back({m_colColor + c, 1.0});
+    }
+}
+
+void InkSprites::enableFrameField()
+{
+    if (m_colFrame != NO_COLUMN)
+        return;
+    m_colFrame = m_data.addColumns(1);
+    m_bindings.push_back({"frame", m_colFrame});
+    m_columnDefaults.push_back({m_colFrame, 0.0});
+}
+
+void InkSprites::markHit(size_t index)
+{
+    enableHitField();
+    m_data.at(m_colHit, index) = 1.0;
+}
+
+void InkSprites::refreshSpatialIndex()
+{
+    if (!m_grid.isConfigured())
+        throw std::runtime_error("InkSprites: spatial index is not enabled");
+    if (!m_gridStale)
+        return;
+    m_grid.rebuild(m_data, POS_X, POS_Y);
+    m_gridStale = false;
+}
+
+void InkSprites::computeNeighbors()
+{
+    // Neighbor directions are sorted into cell order with the positions
+    m_grid.rebuild(m_data, POS_X, POS_Y, {DIR_X, DIR_Y});
+    m_gridStale = false;
+
+    const double radius = m_neighborRadius;
+    const double r2 = radius * radius;
+
+    jobs::parallelFor(m_data.blockCount(), 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t b = begin; b < end; b++)
+        {
+            const double *px = m_data.column(b, POS_X);
+            const double *py = m_data.column(b, POS_Y);
+            double *outCount = m_data.column(b, m_colNeighbors + NEIGHBOR_COUNT);
+            double *outDirX = m_data.column(b, m_colNeighbors + NEIGHBOR_DIR_X);
+            double *outDirY = m_data.column(b, m_colNeighbors + NEIGHBOR_DIR_Y);
+            double *outCenterX = m_data.column(b, m_colNeighbors + NEIGHBOR_CENTER_X);
+            double *outCenterY = m_data.column(b, m_colNeighbors + NEIGHBOR_CENTER_Y);
+
+            size_t base = b * ChunkedSoA::BLOCK_SIZE;
+            size_t n = m_data.blockSize(b);
+            for (size_t i = 0; i < n; i++)
+            {
+                const uint32_t self = static_cast<uint32_t>(base + i);
+                const double x = px[i];
+                const double y = py[i];
+
+                // Branch-free accumulation: roughly half the candidates fail
+                // the distance test, which would otherwise mispredict badly.
+                double count = 0.0;
+                double dirX = 0.0, dirY = 0.0, sumX = 0.0, sumY = 0.0;
+                m_grid.forEachCandidate(x - radius, y - radius, x + radius, y + radius,
+                                        [&](size_t slot)
+                                        {
+                                            double qx = m_grid.xAt(slot);
+                                            double qy = m_grid.yAt(slot);
+                                            double dx = qx - x;
+                                            double dy = qy - y;
+                                            double hit = (dx * dx + dy * dy <= r2) & (m_grid.indexAt(slot) != self);
+                                            count += hit;
+                                            dirX += hit * m_grid.payloadAt(0, slot);
+                                            dirY += hit * m_grid.payloadAt(1, slot);
+                                            sumX += hit * qx;
+                                            sumY += hit * qy;
+                                        });
+
+                outCount[i] = count;
+                if (count > 0.0)
+                {
+                    double inv = 1.0 / count;
+                    outDirX[i] = dirX * inv;
+                    outDirY[i] = dirY * inv;
+                    outCenterX[i] = sumX * inv;
+                    outCenterY[i] = sumY * inv;
+                }
+                else
+                {
+                    outDirX[i] = 0.0;
+                    outDirY[i] = 0.0;
+                    outCenterX[i] = x;
+                    outCenterY[i] = y;
+                }
+            }
+        } });
+}
+
+// Frames differ in size, so culling bounds each sprite by the largest
+static renderer::QuadParams cullParamsFor(renderer::QuadParams params, const renderer::FrameTable *frames)
+{
+    if (frames)
+    {
+        const Vec2 largest = frames->maxSize();
+        params.clipW = largest.x;
+        params.clipH = largest.y;
+    }
+    return params;
 }
 
 void InkSprites::update(double dt)
 {
-    if (m_size == 0)
+    if (m_data.size() == 0)
         return;
 
-    rebindFields();
+    // One interpreter per partition of the blocks, each with the per-frame
+    // constants
+    const size_t blocks = m_data.blockCount();
+    const size_t partitions = std::max<size_t>(1, std::min(jobs::concurrency(), blocks));
+    if (m_interpreters.size() < partitions)
+        m_interpreters.resize(partitions);
+    for (size_t p = 0; p < partitions; p++)
+    {
+        ink::Interpreter &interpreter = m_interpreters[p];
+        interpreter.setConstant("dt", dt);
+        interpreter.setConstant("bounds.x", m_bounds.x);
+        interpreter.setConstant("bounds.y", m_bounds.y);
+        interpreter.setConstant("bounds.w", m_bounds.w);
+        interpreter.setConstant("bounds.h", m_bounds.h);
+        interpreter.setConstant("PI", M_PI);
+    }
 
-    // Per-frame constants
-    m_interpreter.setConstant("dt", dt);
-    m_interpreter.setConstant("bounds.x", m_bounds.x);
-    m_interpreter.setConstant("bounds.y", m_bounds.y);
-    m_interpreter.setConstant("bounds.w", m_bounds.w);
-    m_interpreter.setConstant("bounds.h", m_bounds.h);
+    if (m_colNeighbors != NO_COLUMN)
+    {
+        if (!m_grid.isConfigured())
+            throw std::runtime_error("Ink: neighbors.* fields require enable_spatial_index()");
+        computeNeighbors();
+    }
 
-    Vec2 texSize = m_texture->getSize();
-    m_interpreter.setConstant("rect_w", texSize.x * m_scale_x[0]);
-    m_interpreter.setConstant("rect_h", texSize.y * m_scale_y[0]);
+    // rect_w/rect_h are recomputed only for dirty blocks; a clip change
+    // invalidates all of them.
+    const Rect clip = m_texture->getClipArea();
+    const bool tracksRects = m_colRect != NO_COLUMN;
+    const bool scriptScales = m_usage.isWritten("scale.x") || m_usage.isWritten("scale.y");
+    if (tracksRects)
+    {
+        if (clip.w != m_rectClipW || clip.h != m_rectClipH)
+        {
+            m_rectClipW = clip.w;
+            m_rectClipH = clip.h;
+            m_rectDirty.assign(m_data.blockCount(), 1);
+        }
+        m_rectDirty.resize(m_data.blockCount(), 1);
+    }
 
-    m_interpreter.setConstant("PI", M_PI);
+    // Fused mode: the quad inputs are read from the texture and camera
+    // here, on the SDL thread, and checked again by render()
+    const bool emit = m_fused && clip.w > 1e-8 && clip.h > 1e-8;
+    const bool cull = emit && renderer::get_culling();
+    renderer::QuadParams cullParams;
+    if (emit)
+    {
+        m_fusedParams = renderer::quad_params(*m_texture, m_fusedAnchor, m_fusedPivot);
+        if (m_colFrame != NO_COLUMN)
+            renderer::frame_table(*m_texture, m_fusedFrames);
+        cullParams = cullParamsFor(m_fusedParams, m_colFrame != NO_COLUMN ? &m_fusedFrames : nullptr);
+        m_fusedCulled = cull;
+        m_fusedViewSize = renderer::get_view_size();
+        m_fusedVisible.resize(blocks);
+        m_visible.resize(blocks * ChunkedSoA::BLOCK_SIZE);
+        m_vertices.resize(m_data.size() * 4);
+    }
+
+    // Each partition runs the behavior over its run of blocks, and in fused
+    // mode culls and emits every block straight after
+    jobs::parallelFor(partitions, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t p = begin; p < end; p++)
+        {
+            ink::Interpreter &interpreter = m_interpreters[p];
+            for (size_t b = blocks * p / partitions; b < blocks * (p + 1) / partitions; b++)
+            {
+                if (tracksRects && m_rectDirty[b])
+                {
+                    refreshRects(b, clip);
+                    m_rectDirty[b] = 0;
+                }
+
+                bindBlock(interpreter, b);
+                interpreter.execute(m_behavior);
+
+                // Reads after the write were served fresh, but a write after
+                // the last read leaves the column behind
+                if (tracksRects && scriptScales &&
+                    (interpreter.wasWritten(m_data.column(b, SCALE_X)) ||
+                     interpreter.wasWritten(m_data.column(b, SCALE_Y))))
+                {
+                    m_rectDirty[b] = 1;
+                }
+
+                if (!emit)
+                    continue;
+
+                size_t visible = m_data.blockSize(b);
+                if (cull)
+                {
+                    visible = renderer::cull_sprites(
+                        cullParams,
+                        m_data.column(b, POS_X), m_data.column(b, POS_Y),
+                        m_data.column(b, SCALE_X), m_data.column(b, SCALE_Y),
+                        visible, m_visible.data() + b * ChunkedSoA::BLOCK_SIZE);
+                }
+                m_fusedVisible[b] = visible;
+                if (visible > 0)
+                    buildVisibleQuads(b, m_fusedParams, m_fusedFrames, visible,
+                                      m_vertices.data() + b * ChunkedSoA::BLOCK_SIZE * 4);
+            }
+        } });
 
-    // Run the behavior script
-    m_interpreter.execute(m_behavior);
+    m_gridStale = true;
+    m_fusedValid = emit;
+    m_version++;
+}
+
+void InkSprites::setFused(bool enabled, const Vec2 &anchor, const Vec2 &pivot)
+{
+    m_fused = enabled;
+    m_fusedAnchor = anchor;
+    m_fusedPivot = pivot;
+    m_fusedValid = false;
 }
 
 void InkSprites::render(const Vec2 &anchor, const Vec2 &pivot)
 {
-    if (m_size == 0)
+    const size_t count = m_data.size();
+    if (count == 0)
+        return;
+
+    Rect clip = m_texture->getClipArea();
+    if (clip.w <= 1e-8 || clip.h <= 1e-8)
+        return;
+
+    if (m_renderMode == RenderMode::DENSITY)
+    {
+        renderDensity(anchor);
+        return;
+    }
+    if (m_renderMode == RenderMode::POINTS ||
+        std::max(clip.w, clip.h) * renderer::get_camera().zoom < m_lodThreshold)
+    {
+        renderPoints(anchor);
+        return;
+    }
+
+    const renderer::QuadParams params = renderer::quad_params(*m_texture, anchor, pivot);
+    const bool frames = m_colFrame != NO_COLUMN;
+    if (frames)
+        renderer::frame_table(*m_texture, m_frames);
+
+    // A fused update() already culled every block and built its visible
+    // quads if nothing the quads depend on has changed since. Otherwise cull
+    // each block into its own slice of m_visible. Without culling every
+    // block is full.
+    const size_t blocks = m_data.blockCount();
+    const bool culling = renderer::get_culling();
+    const bool reuseFused = m_fusedValid && params == m_fusedParams && (!frames || m_frames == m_fusedFrames) &&
+                            m_fusedCulled == culling && m_fusedViewSize == renderer::get_view_size();
+    m_visible.resize(blocks * ChunkedSoA::BLOCK_SIZE);
+    m_visibleOffsets.resize(blocks + 1);
+    if (reuseFused)
+    {
+        std::copy_n(m_fusedVisible.data(), blocks, m_visibleOffsets.data());
+    }
+    else if (culling)
+    {
+        const renderer::QuadParams cullParams = cullParamsFor(params, frames ? &m_frames : nullptr);
+        jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t b = begin; b < end; b++)
+            {
+                m_visibleOffsets[b] = renderer::cull_sprites(
+                    cullParams,
+                    m_data.column(b, POS_X), m_data.column(b, POS_Y),
+                    m_data.column(b, SCALE_X), m_data.column(b, SCALE_Y),
+                    m_data.blockSize(b), m_visible.data() + b * ChunkedSoA::BLOCK_SIZE);
+            } });
+    }
+    else
+    {
+        for (size_t b = 0; b < blocks; b++)
+            m_visibleOffsets[b] = m_data.blockSize(b);
+    }
+
+    // Turn the counts into offsets so every block knows where its quads go
+    // in the packed vertex buffer
+    size_t visible = 0;
+    for (size_t b = 0; b < blocks; b++)
+    {
+        const size_t n = m_visibleOffsets[b];
+        m_visibleOffsets[b] = visible;
+        visible += n;
+    }
+    m_visibleOffsets[blocks] = visible;
+    renderer::_count_culled(count - visible);
+    if (visible == 0)
+        return;
+
+    auto visibleIn = [&](size_t b)
+    { return m_visibleOffsets[b + 1] - m_visibleOffsets[b]; };
+
+    // Fused quads sit at the start of each block's slot, so packing them is
+    // one contiguous copy per block. Otherwise workers build the visible
+    // quads straight into place, skipping the index list for blocks that are
+    // entirely on screen.
+    const SDL_Vertex *vertices = m_vertices.data();
+    if (reuseFused && visible < count)
+    {
+        m_culledVertices.resize(visible * 4);
+        jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t b = begin; b < end; b++)
+                std::copy_n(m_vertices.data() + b * ChunkedSoA::BLOCK_SIZE * 4, visibleIn(b) * 4,
+                            m_culledVertices.data() + m_visibleOffsets[b] * 4); });
+        vertices = m_culledVertices.data();
+    }
+    else if (!reuseFused)
+    {
+        m_vertices.resize(count * 4);
+        jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t b = begin; b < end; b++)
+                buildVisibleQuads(b, params, m_frames, visibleIn(b),
+                                  m_vertices.data() + m_visibleOffsets[b] * 4); });
+        vertices = m_vertices.data();
+
+        // m_vertices is packed now, no longer laid out by block
+        m_fusedValid = false;
+    }
+
+    const size_t drawn = renderer::draw_quads(*m_texture, vertices, visible);
+
+    // Per-sprite fallback for whatever the renderer rejected; it draws the
+    // clip area rather than each sprite's frame
+    for (size_t b = 0; b < blocks; b++)
+    {
+        if (m_visibleOffsets[b + 1] <= drawn)
+            continue;
+
+        const size_t n = visibleIn(b);
+        const size_t skip = m_visibleOffsets[b] < drawn ? drawn - m_visibleOffsets[b] : 0;
+        const uint32_t *indices = m_visible.data() + b * ChunkedSoA::BLOCK_SIZE;
+        for (size_t k = skip; k < n; k++)
+        {
+            const size_t i = n == m_data.blockSize(b) ? k : indices[k];
+            renderer::draw_batch_soa_rotated(
+                *m_texture,
+                m_data.column(b, POS_X) + i, m_data.column(b, POS_Y) + i,
+                m_data.column(b, ROT) + i,
+                m_data.column(b, SCALE_X) + i, m_data.column(b, SCALE_Y) + i,
+                1, anchor, pivot);
+        }
+    }
+}
+
+void InkSprites::setPointSize(double pixels)
+{
+    if (!(pixels > 0.0))
+        throw std::invalid_argument("Point size must be positive");
+    m_pointSize = pixels;
+}
+
+void InkSprites::setDensityCellSize(int pixels)
+{
+    if (pixels <= 0)
+        throw std::invalid_argument("Density cell size must be positive");
+    m_densityCellSize = pixels;
+}
+
+void InkSprites::renderPoints(const Vec2 &anchor)
+{
+    // Sprite centers through the camera; points off the view are dropped
+    // with the same count-then-write compaction as culling
+    const renderer::QuadParams view = renderer::quad_params(*m_texture, anchor, anchor);
+    const Vec2 viewSize = renderer::get_view_size();
+    const double half = m_pointSize * 0.5;
+    const double centerX = view.clipW * (0.5 - anchor.x);
+    const double centerY = view.clipH * (0.5 - anchor.y);
+    const bool colored = m_colColor != NO_COLUMN;
+    const bool usePoints = m_pointSize <= 1.0 && !colored;
+
+    auto project = [&](size_t b, size_t i, double &x, double &y)
+    {
+        const double wx = m_data.column(b, POS_X)[i] + centerX * m_data.column(b, SCALE_X)[i];
+        const double wy = m_data.column(b, POS_Y)[i] + centerY * m_data.column(b, SCALE_Y)[i];
+        x = view.viewCos * wx + view.viewSin * wy + view.viewX;
+        y = -view.viewSin * wx + view.viewCos * wy + view.viewY;
+        return x >= -half && x <= viewSize.x + half && y >= -half && y <= viewSize.y + half;
+    };
+
+    const size_t blocks = m_data.blockCount();
+    m_visibleOffsets.resize(blocks + 1);
+    jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t b = begin; b < end; b++)
+        {
+            size_t visible = 0;
+            double x, y;
+            for (size_t i = 0; i < m_data.blockSize(b); i++)
+                visible += project(b, i, x, y);
+            m_visibleOffsets[b] = visible;
+        } });
+
+    size_t total = 0;
+    for (size_t b = 0; b < blocks; b++)
+    {
+        const size_t n = m_visibleOffsets[b];
+        m_visibleOffsets[b] = total;
+        total += n;
+    }
+    m_visibleOffsets[blocks] = total;
+    renderer::_count_culled(m_data.size() - total);
+    if (total == 0)
+        return;
+
+    const SDL_FColor base{
+        m_pointColor.r / 255.0f, m_pointColor.g / 255.0f, m_pointColor.b / 255.0f,
+        m_pointColor.a / 255.0f * m_texture->getAlpha()};
+
+    if (usePoints)
+    {
+        m_points.resize(total);
+        jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t b = begin; b < end; b++)
+            {
+                SDL_FPoint *out = m_points.data() + m_visibleOffsets[b];
+                size_t k = 0;
+                double x, y;
+                for (size_t i = 0; i < m_data.blockSize(b); i++)
+                {
+                    if (project(b, i, x, y))
+                        out[k++] = {static_cast<float>(x), static_cast<float>(y)};
+                }
+            } });
+        renderer::draw_points(m_points.data(), total, base);
         return;
+    }
+
+    // Small untextured quads, which can carry per-sprite colors. Only
+    // visible points are written, so each block stays inside its slice
+    m_vertices.resize(total * 4);
+    m_fusedValid = false;
+    const float h = static_cast<float>(half);
+    jobs::parallelFor(blocks, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t b = begin; b < end; b++)
+        {
+            SDL_Vertex *out = m_vertices.data() + m_visibleOffsets[b] * 4;
+            const double *r = colored ? m_data.column(b, m_colColor) : nullptr;
+            size_t k = 0;
+            double x, y;
+            for (size_t i = 0; i < m_data.blockSize(b); i++)
+            {
+                if (!project(b, i, x, y))
+                    continue;
+
+                SDL_FColor color = base;
+                if (colored)
+                {
+                    color.r *= static_cast<float>(std::clamp(r[i], 0.0, 1.0));
+                    color.g *= static_cast<float>(std::clamp(m_data.column(b, m_colColor + 1)[i], 0.0, 1.0));
+                    color.b *= static_cast<float>(std::clamp(m_data.column(b, m_colColor + 2)[i], 0.0, 1.0));
+                    color.a *= static_cast<float>(std::clamp(m_data.column(b, m_colColor + 3)[i], 0.0, 1.0));
+                }
+
+                const float fx = static_cast<float>(x);
+                const float fy = static_cast<float>(y);
+                SDL_Vertex *v = out + k * 4;
+                v[0] = {{fx - h, fy - h}, color, {0.0f, 0.0f}};
+                v[1] = {{fx + h, fy - h}, color, {0.0f, 0.0f}};
+                v[2] = {{fx + h, fy + h}, color, {0.0f, 0.0f}};
+                v[3] = {{fx - h, fy + h}, color, {0.0f, 0.0f}};
+                k++;
+            }
+        } });
+    renderer::draw_colored_quads(m_vertices.data(), total);
+}
+
+void InkSprites::renderDensity(const Vec2 &anchor)
+{
+    const renderer::QuadParams view = renderer::quad_params(*m_texture, anchor, anchor);
+    const Vec2 viewSize = renderer::get_view_size();
+    const int cell = m_densityCellSize;
+    const int gridW = std::max(1, static_cast<int>(std::ceil(viewSize.x / cell)));
+    const int gridH = std::max(1, static_cast<int>(std::ceil(viewSize.y / cell)));
+    const size_t cells = static_cast<size_t>(gridW) * gridH;
+    const double centerX = view.clipW * (0.5 - anchor.x);
+    const double centerY = view.clipH * (0.5 - anchor.y);
+    const double toCell = 1.0 / cell;
+
+    if (!m_densityTexture || gridW != m_densityW || gridH != m_densityH)
+    {
+        SDL_Texture *texture = SDL_CreateTexture(
+            renderer::_get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, gridW, gridH);
+        m_densityTexture = std::make_unique<Texture>(Texture::share(texture));
+
+        // One texel per cell; linear filtering would blend neighboring cells
+        SDL_SetTextureScaleMode(texture, SDL_SCALEMODE_NEAREST);
+        m_densityW = gridW;
+        m_densityH = gridH;
+    }
+
+    // Each partition of the blocks counts into its own bins, so no atomics;
+    // off-view sprites add 0 to cell 0 instead of branching
+    const size_t blocks = m_data.blockCount();
+    const size_t partitions = std::max<size_t>(1, std::min(jobs::concurrency(), blocks));
+    m_densityBins.resize(partitions * cells);
+    m_densityInside.resize(partitions);
+    jobs::parallelFor(partitions, 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t p = begin; p < end; p++)
+        {
+            uint32_t *bins = m_densityBins.data() + p * cells;
+            std::fill_n(bins, cells, 0u);
+            size_t inside = 0;
+            for (size_t b = blocks * p / partitions; b < blocks * (p + 1) / partitions; b++)
+            {
+                const double *px = m_data.column(b, POS_X);
+                const double *py = m_data.column(b, POS_Y);
+                const double *sx = m_data.column(b, SCALE_X);
+                const double *sy = m_data.column(b, SCALE_Y);
+                for (size_t i = 0; i < m_data.blockSize(b); i++)
+                {
+                    const double wx = px[i] + centerX * sx[i];
+                    const double wy = py[i] + centerY * sy[i];
+                    const double cx = (view.viewCos * wx + view.viewSin * wy + view.viewX) * toCell;
+                    const double cy = (-view.viewSin * wx + view.viewCos * wy + view.viewY) * toCell;
+                    const bool isInside = cx >= 0.0 && cx < gridW && cy >= 0.0 && cy < gridH;
+                    const size_t index = isInside ? static_cast<size_t>(cy) * gridW + static_cast<size_t>(cx) : 0;
+                    bins[index] += isInside;
+                    inside += isInside;
+                }
+            }
+            m_densityInside[p] = inside;
+        } });
+
+    size_t binned = 0;
+    for (size_t p = 0; p < partitions; p++)
+        binned += m_densityInside[p];
+    renderer::_count_culled(m_data.size() - binned);
+
+    // Sum the partitions into the first, row by row, tracking each row's peak
+    m_densityRowMax.resize(gridH);
+    jobs::parallelFor(gridH, 16, [&](size_t begin, size_t end)
+                      {
+        for (size_t row = begin; row < end; row++)
+        {
+            uint32_t *sum = m_densityBins.data() + row * gridW;
+            for (size_t p = 1; p < partitions; p++)
+            {
+                const uint32_t *bins = m_densityBins.data() + p * cells + row * gridW;
+                for (int x = 0; x < gridW; x++)
+                    sum[x] += bins[x];
+            }
+            m_densityRowMax[row] = *std::max_element(sum, sum + gridW);
+        } });
+
+    const uint32_t peak = *std::max_element(m_densityRowMax.begin(), m_densityRowMax.end());
+    if (peak == 0)
+        return;
+
+    // Log scale, so sparse regions stay visible next to dense clusters
+    const float scale = 1.0f / std::log1p(static_cast<float>(peak));
+    const uint8_t rgba[4] = {
+        static_cast<uint8_t>(std::clamp(m_pointColor.r, 0, 255)),
+        static_cast<uint8_t>(std::clamp(m_pointColor.g, 0, 255)),
+        static_cast<uint8_t>(std::clamp(m_pointColor.b, 0, 255)),
+        static_cast<uint8_t>(std::clamp(m_pointColor.a, 0, 255))};
+    m_densityPixels.resize(cells);
+    jobs::parallelFor(gridH, 16, [&](size_t begin, size_t end)
+                      {
+        for (size_t row = begin; row < end; row++)
+        {
+            const uint32_t *sum = m_densityBins.data() + row * gridW;
+            uint8_t *out = reinterpret_cast<uint8_t *>(m_densityPixels.data() + row * gridW);
+            for (int x = 0; x < gridW; x++)
+            {
+                const float t = std::log1p(static_cast<float>(sum[x])) * scale;
+                out[x * 4] = rgba[0];
+                out[x * 4 + 1] = rgba[1];
+                out[x * 4 + 2] = rgba[2];
+                out[x * 4 + 3] = static_cast<uint8_t>(rgba[3] * t + 0.5f);
+            }
+        } });
 
-    renderer::draw_batch_soa(
-        *m_texture,
-        m_pos_x.data(), m_pos_y.data(),
-        m_rot.data(),
-        m_scale_x.data(), m_scale_y.data(),
-        m_size,
-        anchor, pivot);
+    SDL_UpdateTexture(m_densityTexture->getSDL(), nullptr, m_densityPixels.data(), gridW * 4);
+    m_densityTexture->setAlpha(m_texture->getAlpha());
+    renderer::draw_screen(*m_densityTexture, Rect(0, 0, gridW * cell, gridH * cell));
 }
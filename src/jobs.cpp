@@ -0,0 +1,188 @@
+#include "Jobs.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jobs
+{
+    // One parallelFor in progress. Lives on the caller's stack; the caller
+    // does not return until every helper has left it.
+    struct ForState
+    {
+        void (*fn)(void *, size_t, size_t);
+        void *context;
+        size_t count;
+        size_t grain;
+        size_t ranges;
+        size_t wanted;      // helpers that may still join, guarded by _mutex
+        size_t helpers{0};  // helpers inside run(), guarded by _mutex
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error; // first exception, set once by whoever flips `failed`
+
+        void run()
+        {
+            for (size_t r = next++; r < ranges; r = next++)
+            {
+                size_t begin = r * grain;
+                try
+                {
+                    fn(context, begin, std::min(begin + grain, count));
+                }
+                catch (...)
+                {
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                    // Leave the remaining ranges unclaimed
+                    next = ranges;
+                    return;
+                }
+            }
+        }
+    };
+
+    static std::vector<std::thread> _workers;
+    static std::deque<std::function<void()>> _queue;
+    static std::vector<ForState *> _fors; // parallelFors that still want helpers
+    static std::mutex _mutex;
+    static std::condition_variable _wake;
+    static std::condition_variable _left; // a helper left a ForState
+    static bool _stopping = false;
+    static std::once_flag _started;
+
+    // Called with _mutex held
+    static ForState *claimFor()
+    {
+        for (ForState *state : _fors)
+        {
+            if (state->wanted > 0 && state->next.load() < state->ranges)
+            {
+                state->wanted--;
+                state->helpers++;
+                return state;
+            }
+        }
+        return nullptr;
+    }
+
+    static void workerLoop()
+    {
+        std::unique_lock lock(_mutex);
+        while (true)
+        {
+            ForState *state = nullptr;
+            _wake.wait(lock, [&]
+                       { return _stopping || !_queue.empty() || (state = claimFor()) != nullptr; });
+
+            if (state)
+            {
+                lock.unlock();
+                state->run();
+                lock.lock();
+                state->helpers--;
+                _left.notify_all();
+                continue;
+            }
+            if (_queue.empty())
+                return;
+
+            std::function<void()> task = std::move(_queue.front());
+            _queue.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    static void start()
+    {
+        std::call_once(_started, []
+                       {
+            size_t hw = std::max(1u, std::thread::hardware_concurrency());
+            _fors.reserve(hw);
+            for (size_t i = 1; i < hw; i++)
+                _workers.emplace_back(workerLoop); });
+    }
+
+    size_t concurrency()
+    {
+        start();
+        return _workers.size() + 1;
+    }
+
+    void submit(std::function<void()> task)
+    {
+        start();
+        if (_workers.empty())
+        {
+            task();
+            return;
+        }
+        {
+            std::lock_guard lock(_mutex);
+            _queue.push_back(std::move(task));
+        }
+        _wake.notify_one();
+    }
+
+    void _parallelFor(size_t count, size_t grain, void (*fn)(void *, size_t, size_t), void *context)
+    {
+        if (count == 0)
+            return;
+        grain = std::max<size_t>(grain, 1);
+
+        size_t ranges = (count + grain - 1) / grain;
+        size_t helpers = std::min(concurrency() - 1, ranges - 1);
+        if (helpers == 0)
+        {
+            fn(context, 0, count);
+            return;
+        }
+
+        ForState state;
+        state.fn = fn;
+        state.context = context;
+        state.count = count;
+        state.grain = grain;
+        state.ranges = ranges;
+        state.wanted = helpers;
+
+        {
+            std::lock_guard lock(_mutex);
+            _fors.push_back(&state);
+        }
+        _wake.notify_all();
+
+        state.run();
+
+        // Every range is claimed; close the state to late helpers and wait
+        // for the ones still inside it
+        {
+            std::unique_lock lock(_mutex);
+            _fors.erase(std::find(_fors.begin(), _fors.end(), &state));
+            _left.wait(lock, [&]
+                       { return state.helpers == 0; });
+        }
+
+        if (state.error)
+            std::rethrow_exception(state.error);
+    }
+
+    void _quit()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stopping = true;
+        }
+        _wake.notify_all();
+        for (auto &worker : _workers)
+            worker.join();
+        _workers.clear();
+    }
+}
@@ -1,8 +1,19 @@
 #include "Renderer.hpp"
 
 #include <SDL3/SDL.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
 
+#include "Capture.hpp"
+#include "FastMath.hpp"
+#include "Jobs.hpp"
 #include "Texture.hpp"
+#include "TextureCache.hpp"
 #include "Transform.hpp"
 
 #ifndef M_PI
@@ -13,27 +24,565 @@ static SDL_Renderer *_renderer = nullptr;
 static int cached_render_width = 1280;
 static int cached_render_height = 720;
 
+// Quads per SDL_RenderGeometry call, and per worker task when building them
+constexpr size_t MAX_BATCH_QUADS = 8192;
+constexpr size_t BUILD_GRAIN = 1024;
+static std::vector<int> batch_indices;
+static std::vector<SDL_Vertex> batch_vertices;
+static bool geometry_unsupported = false;
+
+// One recorded draw() call. Texture state is captured at record time, so
+// changing clip area, flip or mods after draw() does not affect it, and the
+// SDL texture is kept alive until the command is flushed.
+struct DrawCommand
+{
+    int layer;
+    uint32_t sequence;
+    std::shared_ptr<SDL_Texture> texture;
+    SDL_BlendMode blend;
+    SDL_FlipMode flip;
+    SDL_FRect src;
+    SDL_FRect dst;
+    SDL_FPoint center; // rotation center relative to dst
+    float angle;       // radians
+    SDL_FColor color;
+};
+
+// Commands recorded since the last flush, and their sorted order
+static std::vector<DrawCommand> draw_queue;
+static std::vector<uint32_t> draw_order;
+static bool strict_order = false;
+
+static Camera camera;
+static uint64_t target_generation = 0;
+static bool culling = true;
+static std::vector<uint32_t> cull_indices;
+static std::vector<size_t> cull_counts;
+
+// State last set through the renderer, so SDL calls that would not change
+// anything are skipped. Texture entries are dropped when the SDL texture is
+// destroyed (see Texture::share).
+struct TextureState
+{
+    SDL_BlendMode blend{SDL_BLENDMODE_INVALID};
+    SDL_FColor color{-1.0f, -1.0f, -1.0f, -1.0f}; // color mod, alpha mod in a
+};
+static std::unordered_map<SDL_Texture *, TextureState> texture_states;
+static SDL_FColor draw_color{-1.0f, -1.0f, -1.0f, -1.0f};
+static SDL_Texture *current_target = nullptr;
+static bool view_size_dirty = true;
+
+// Counters for the frame in progress, and a ring of finished frames
+static renderer::FrameStats frame_stats;
+static std::vector<renderer::FrameStats> stats_history(120);
+static size_t stats_head = 0;
+static size_t stats_count = 0;
+static uint64_t frame_index = 0;
+static SDL_Texture *bound_texture = nullptr;
+
 constexpr double TO_DEGREES(const double radians)
 {
     return radians * (180.0 / M_PI);
 }
 
+// Cache the visible area, in the coordinates sprites are drawn in: the
+// render target's size, else the logical size when letterboxing
+static void refresh_view_size()
+{
+    view_size_dirty = false;
+    if (SDL_Texture *target = SDL_GetRenderTarget(_renderer))
+    {
+        float w = 0.0f, h = 0.0f;
+        SDL_GetTextureSize(target, &w, &h);
+        cached_render_width = static_cast<int>(w);
+        cached_render_height = static_cast<int>(h);
+        return;
+    }
+
+    SDL_RendererLogicalPresentation mode = SDL_LOGICAL_PRESENTATION_DISABLED;
+    if (!SDL_GetRenderLogicalPresentation(_renderer, &cached_render_width, &cached_render_height, &mode) ||
+        mode == SDL_LOGICAL_PRESENTATION_DISABLED)
+    {
+        SDL_GetCurrentRenderOutputSize(_renderer, &cached_render_width, &cached_render_height);
+    }
+}
+
+// The current camera as the affine map described on QuadParams
+struct ViewTransform
+{
+    double cos, sin;
+    double x, y;
+    double angle;
+    double zoom;
+
+    double mapX(double wx, double wy) const { return cos * wx + sin * wy + x; }
+    double mapY(double wx, double wy) const { return -sin * wx + cos * wy + y; }
+};
+
+static ViewTransform view_transform()
+{
+    // Around the view center: center + zoom * R(-rot) * (world - pos - center)
+    const double centerX = cached_render_width * 0.5;
+    const double centerY = cached_render_height * 0.5;
+    const double c = std::cos(camera.rot) * camera.zoom;
+    const double s = std::sin(camera.rot) * camera.zoom;
+    const double originX = camera.pos.x + centerX;
+    const double originY = camera.pos.y + centerY;
+
+    return {
+        c,
+        s,
+        centerX - (c * originX + s * originY),
+        centerY - (-s * originX + c * originY),
+        camera.rot,
+        camera.zoom,
+    };
+}
+
+static TextureState &texture_state(SDL_Texture *texture)
+{
+    return texture_states[texture];
+}
+
+static void set_texture_blend(SDL_Texture *texture, TextureState &state, SDL_BlendMode blend)
+{
+    if (state.blend == blend)
+    {
+        frame_stats.stateCallsSkipped++;
+        return;
+    }
+    SDL_SetTextureBlendMode(texture, blend);
+    state.blend = blend;
+    frame_stats.stateCalls++;
+}
+
+static void set_texture_mods(SDL_Texture *texture, TextureState &state, const SDL_FColor &color)
+{
+    if (state.color.r == color.r && state.color.g == color.g && state.color.b == color.b)
+    {
+        frame_stats.stateCallsSkipped++;
+    }
+    else
+    {
+        SDL_SetTextureColorModFloat(texture, color.r, color.g, color.b);
+        frame_stats.stateCalls++;
+    }
+
+    if (state.color.a == color.a)
+    {
+        frame_stats.stateCallsSkipped++;
+    }
+    else
+    {
+        SDL_SetTextureAlphaModFloat(texture, color.a);
+        frame_stats.stateCalls++;
+    }
+    state.color = color;
+}
+
+// Count a submission to SDL with `texture` (null for untextured draws)
+static void count_submit(SDL_Texture *texture, size_t sprites, size_t vertices)
+{
+    frame_stats.drawCalls++;
+    frame_stats.sprites += sprites;
+    frame_stats.vertices += vertices;
+    if (texture != bound_texture)
+    {
+        frame_stats.textureBinds++;
+        bound_texture = texture;
+    }
+}
+
+static void set_draw_color(const SDL_FColor &color)
+{
+    if (draw_color.r == color.r && draw_color.g == color.g && draw_color.b == color.b && draw_color.a == color.a)
+    {
+        frame_stats.stateCallsSkipped++;
+        return;
+    }
+    SDL_SetRenderDrawColorFloat(_renderer, color.r, color.g, color.b, color.a);
+    draw_color = color;
+    frame_stats.stateCalls++;
+}
+
+// Squared distance from a point to the visible area; a sprite is on screen
+// if this is within the squared radius of its bounding circle
+static inline double view_distance_sq(double x, double y)
+{
+    const double halfW = cached_render_width * 0.5;
+    const double halfH = cached_render_height * 0.5;
+    const double dx = std::max(std::abs(x - halfW) - halfW, 0.0);
+    const double dy = std::max(std::abs(y - halfH) - halfH, 0.0);
+    return dx * dx + dy * dy;
+}
+
+// Submit quads (4 vertices each) in chunks; returns the number submitted
+static size_t submit_quads(SDL_Texture *texture, const SDL_Vertex *vertices, size_t quadCount)
+{
+    if (geometry_unsupported)
+        return 0;
+
+    if (batch_indices.empty())
+    {
+        batch_indices.resize(MAX_BATCH_QUADS * 6);
+        for (size_t q = 0; q < MAX_BATCH_QUADS; q++)
+        {
+            const int base = static_cast<int>(q * 4);
+            int *idx = batch_indices.data() + q * 6;
+            idx[0] = base;
+            idx[1] = base + 1;
+            idx[2] = base + 2;
+            idx[3] = base;
+            idx[4] = base + 2;
+            idx[5] = base + 3;
+        }
+    }
+
+    size_t done = 0;
+    while (done < quadCount)
+    {
+        const size_t n = std::min(MAX_BATCH_QUADS, quadCount - done);
+        if (!SDL_RenderGeometry(
+                _renderer, texture,
+                vertices + done * 4, static_cast<int>(n * 4),
+                batch_indices.data(), static_cast<int>(n * 6)))
+        {
+            // Remember so later batches go straight to the fallback
+            geometry_unsupported = true;
+            break;
+        }
+        count_submit(texture, n, n * 4);
+        done += n;
+    }
+    return done;
+}
+
+// Corners of a recorded draw, matching SDL_RenderTextureRotated
+static void command_quad(const DrawCommand &cmd, float texW, float texH, SDL_Vertex *v)
+{
+    const float cx = cmd.dst.x + cmd.center.x;
+    const float cy = cmd.dst.y + cmd.center.y;
+    const float x0 = -cmd.center.x;
+    const float x1 = cmd.dst.w - cmd.center.x;
+    const float y0 = -cmd.center.y;
+    const float y1 = cmd.dst.h - cmd.center.y;
+
+    float u0 = cmd.src.x / texW;
+    float u1 = (cmd.src.x + cmd.src.w) / texW;
+    float v0 = cmd.src.y / texH;
+    float v1 = (cmd.src.y + cmd.src.h) / texH;
+    if (cmd.flip & SDL_FLIP_HORIZONTAL)
+        std::swap(u0, u1);
+    if (cmd.flip & SDL_FLIP_VERTICAL)
+        std::swap(v0, v1);
+
+    float s, c;
+    fastmath::sincos(cmd.angle, s, c);
+
+    v[0] = {{c * x0 - s * y0 + cx, s * x0 + c * y0 + cy}, cmd.color, {u0, v0}};
+    v[1] = {{c * x1 - s * y0 + cx, s * x1 + c * y0 + cy}, cmd.color, {u1, v0}};
+    v[2] = {{c * x1 - s * y1 + cx, s * x1 + c * y1 + cy}, cmd.color, {u1, v1}};
+    v[3] = {{c * x0 - s * y1 + cx, s * x0 + c * y1 + cy}, cmd.color, {u0, v1}};
+}
+
+// Start of any SDL draw: queued draws go first, and a captured frame still
+// in the capture target is read back before the target is drawn over
+static void begin_draw()
+{
+    renderer::flush();
+    capture::_begin();
+}
+
+// Draw a run of sorted commands sharing one texture and blend mode
+static void flush_run(const uint32_t *order, size_t count)
+{
+    const DrawCommand &first = draw_queue[order[0]];
+    SDL_Texture *texture = first.texture.get();
+    TextureState &state = texture_state(texture);
+
+    set_texture_blend(texture, state, first.blend);
+
+    float texW = 1.0f, texH = 1.0f;
+    SDL_GetTextureSize(texture, &texW, &texH);
+
+    size_t done = 0;
+    while (done < count && !geometry_unsupported)
+    {
+        const size_t n = std::min(MAX_BATCH_QUADS, count - done);
+        batch_vertices.resize(n * 4);
+        for (size_t k = 0; k < n; k++)
+            command_quad(draw_queue[order[done + k]], texW, texH, batch_vertices.data() + k * 4);
+
+        const size_t drawn = submit_quads(texture, batch_vertices.data(), n);
+        done += drawn;
+        if (drawn < n)
+            break;
+    }
+
+    // Per-command fallback; geometry ignores texture mods but this path
+    // doesn't, so apply each command's color
+    for (; done < count; done++)
+    {
+        const DrawCommand &cmd = draw_queue[order[done]];
+        set_texture_mods(texture, state, cmd.color);
+        SDL_RenderTextureRotated(
+            _renderer, texture, &cmd.src, &cmd.dst, TO_DEGREES(cmd.angle),
+            &cmd.center, cmd.flip);
+        count_submit(texture, 1, 0);
+    }
+}
+
 namespace renderer
 {
     void clear(const Color &color)
     {
-        // Cache render output size at the start of frame
-        SDL_GetCurrentRenderOutputSize(_renderer, &cached_render_width, &cached_render_height);
-        SDL_SetRenderDrawColor(_renderer, color.r, color.g, color.b, color.a);
+        begin_draw();
+
+        if (view_size_dirty)
+            refresh_view_size();
+        set_draw_color({color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f});
         SDL_RenderClear(_renderer);
     }
 
     void present()
     {
+        flush();
+
+        // A captured frame is drawn offscreen; capture copies it to the
+        // window and reads it back later
+        if (capture::isActive())
+        {
+            capture::_begin();
+            const bool drawn = current_target == capture::_target();
+            capture::_present(drawn);
+            if (drawn)
+                current_target = nullptr;
+        }
         SDL_RenderPresent(_renderer);
+
+        frame_stats.frame = frame_index++;
+        stats_history[stats_head] = frame_stats;
+        stats_head = (stats_head + 1) % stats_history.size();
+        stats_count = std::min(stats_count + 1, stats_history.size());
+        frame_stats = {};
+
+        // Finished background loads are uploaded between frames
+        textures::_pump();
+
+        // The next frame goes to the capture target instead of the window
+        if (current_target == nullptr && capture::isActive())
+            set_target(nullptr);
+    }
+
+    void flush()
+    {
+        if (draw_queue.empty())
+            return;
+        capture::_begin();
+
+        const size_t count = draw_queue.size();
+        draw_order.resize(count);
+        for (size_t i = 0; i < count; i++)
+            draw_order[i] = static_cast<uint32_t>(i);
+
+        // Sequence numbers are unique, so both orders are total
+        if (strict_order)
+        {
+            std::sort(draw_order.begin(), draw_order.end(), [](uint32_t a, uint32_t b)
+                      {
+                const DrawCommand &ca = draw_queue[a];
+                const DrawCommand &cb = draw_queue[b];
+                if (ca.layer != cb.layer)
+                    return ca.layer < cb.layer;
+                return ca.sequence < cb.sequence; });
+        }
+        else
+        {
+            std::sort(draw_order.begin(), draw_order.end(), [](uint32_t a, uint32_t b)
+                      {
+                const DrawCommand &ca = draw_queue[a];
+                const DrawCommand &cb = draw_queue[b];
+                if (ca.layer != cb.layer)
+                    return ca.layer < cb.layer;
+                if (ca.texture != cb.texture)
+                    return std::less<SDL_Texture *>()(ca.texture.get(), cb.texture.get());
+                if (ca.blend != cb.blend)
+                    return ca.blend < cb.blend;
+                return ca.sequence < cb.sequence; });
+        }
+
+        // Merge consecutive commands sharing texture and blend mode
+        size_t begin = 0;
+        while (begin < count)
+        {
+            const DrawCommand &first = draw_queue[draw_order[begin]];
+            size_t end = begin + 1;
+            while (end < count &&
+                   draw_queue[draw_order[end]].texture == first.texture &&
+                   draw_queue[draw_order[end]].blend == first.blend)
+                end++;
+
+            flush_run(draw_order.data() + begin, end - begin);
+            begin = end;
+        }
+
+        draw_queue.clear();
+    }
+
+    void set_strict_order(bool enabled)
+    {
+        if (enabled != strict_order)
+            flush();
+        strict_order = enabled;
+    }
+
+    bool get_strict_order()
+    {
+        return strict_order;
+    }
+
+    void set_camera(const Camera &newCamera)
+    {
+        if (!(newCamera.zoom > 0.0))
+            throw std::invalid_argument("Camera zoom must be positive");
+        camera = newCamera;
+    }
+
+    const Camera &get_camera()
+    {
+        return camera;
+    }
+
+    Vec2 get_view_size()
+    {
+        return {cached_render_width, cached_render_height};
+    }
+
+    Vec2 world_to_screen(const Vec2 &point)
+    {
+        const ViewTransform view = view_transform();
+        return {view.mapX(point.x, point.y), view.mapY(point.x, point.y)};
+    }
+
+    Vec2 screen_to_world(const Vec2 &point)
+    {
+        // pos + center + R(rot) * (screen - center) / zoom
+        const double centerX = cached_render_width * 0.5;
+        const double centerY = cached_render_height * 0.5;
+        const double x = (point.x - centerX) / camera.zoom;
+        const double y = (point.y - centerY) / camera.zoom;
+        const double c = std::cos(camera.rot);
+        const double s = std::sin(camera.rot);
+        return {camera.pos.x + centerX + c * x - s * y, camera.pos.y + centerY + s * x + c * y};
+    }
+
+    void set_target(SDL_Texture *target)
+    {
+        // While capturing, the window is drawn through capture's target
+        if (!target)
+            target = capture::_target();
+
+        if (target == current_target)
+        {
+            frame_stats.stateCallsSkipped++;
+            return;
+        }
+
+        // Queued draws belong to the old target
+        flush();
+        if (!SDL_SetRenderTarget(_renderer, target))
+            throw std::runtime_error("Failed to set render target: " + std::string(SDL_GetError()));
+        current_target = target;
+        frame_stats.stateCalls++;
+        frame_stats.targetSwitches++;
+        refresh_view_size();
+    }
+
+    SDL_Texture *get_target()
+    {
+        return current_target == capture::_target() ? nullptr : current_target;
+    }
+
+    uint64_t target_generation()
+    {
+        return ::target_generation;
+    }
+
+    void _targets_lost()
+    {
+        ::target_generation++;
+
+        // A device reset may not keep texture state
+        texture_states.clear();
+        bound_texture = nullptr;
+        draw_color = {-1.0f, -1.0f, -1.0f, -1.0f};
+    }
+
+    void _view_changed()
+    {
+        view_size_dirty = true;
+    }
+
+    void _forget_texture(SDL_Texture *texture)
+    {
+        texture_states.erase(texture);
+        if (bound_texture == texture)
+            bound_texture = nullptr;
+    }
+
+    FrameStats get_frame_stats()
+    {
+        if (stats_count == 0)
+            return {};
+        return stats_history[(stats_head + stats_history.size() - 1) % stats_history.size()];
     }
 
-    void draw(const Texture &texture, const Transform &transform, const Vec2 &anchor, const Vec2 &pivot)
+    std::vector<FrameStats> get_stats_history()
+    {
+        std::vector<FrameStats> frames;
+        frames.reserve(stats_count);
+        const size_t first = (stats_head + stats_history.size() - stats_count) % stats_history.size();
+        for (size_t i = 0; i < stats_count; i++)
+            frames.push_back(stats_history[(first + i) % stats_history.size()]);
+        return frames;
+    }
+
+    void set_stats_history(size_t frames)
+    {
+        if (frames == 0)
+            throw std::invalid_argument("Stats history needs at least one frame");
+
+        // Keep the newest frames that fit
+        std::vector<FrameStats> kept = get_stats_history();
+        if (kept.size() > frames)
+            kept.erase(kept.begin(), kept.end() - frames);
+        stats_history.assign(frames, {});
+        std::copy(kept.begin(), kept.end(), stats_history.begin());
+        stats_count = kept.size();
+        stats_head = stats_count % frames;
+    }
+
+    size_t get_stats_history_size()
+    {
+        return stats_history.size();
+    }
+
+    void _count_culled(size_t count)
+    {
+        frame_stats.culled += count;
+    }
+
+    void set_culling(bool enabled)
+    {
+        culling = enabled;
+    }
+
+    bool get_culling()
+    {
+        return culling;
+    }
+
+    void draw(const Texture &texture, const Transform &transform, const Vec2 &anchor, const Vec2 &pivot, int layer)
     {
         Rect clipArea = texture.getClipArea();
         if (clipArea.w <= 1e-8 || clipArea.h <= 1e-8)
@@ -41,23 +590,34 @@ namespace renderer
 
         if (std::abs(transform.scale.x) < 1e-8 && std::abs(transform.scale.y) < 1e-8)
             return;
-        if (texture.getAlpha() == 0.0f)
+
+        const SDL_FColor color = texture.getVertexColor();
+        if (color.a == 0.0f)
             return;
 
+        // Place the sprite in the world, then move its rotation center
+        // through the camera and scale it by the zoom around that center
+        const ViewTransform view = view_transform();
         Vec2 clipSize{clipArea.w, clipArea.h};
-        Vec2 dstSize = clipSize * transform.scale;
-        Vec2 dstPos = transform.pos - dstSize * anchor;
+        Vec2 worldSize = clipSize * transform.scale;
+        Vec2 worldCenter = transform.pos + worldSize * (pivot - anchor);
+        Vec2 dstSize = worldSize * view.zoom;
+        Vec2 dstPos = Vec2{view.mapX(worldCenter.x, worldCenter.y), view.mapY(worldCenter.x, worldCenter.y)} -
+                      dstSize * pivot;
         Rect dstRect{dstPos.x, dstPos.y, dstSize.x, dstSize.y};
 
-        // int w = cached_render_width;
-        // int h = cached_render_height;
-        // if (dstRect.x + dstRect.w < 0.0 ||
-        //     dstRect.x >= static_cast<double>(w) ||
-        //     dstRect.y + dstRect.h < 0.0 ||
-        //     dstRect.y >= static_cast<double>(h))
-        // {
-        //     return;
-        // }
+        if (culling)
+        {
+            // Bounding circle around the rotation center, as in cull_sprites
+            const double reachX = std::max(pivot.x, 1.0 - pivot.x) * dstSize.x;
+            const double reachY = std::max(pivot.y, 1.0 - pivot.y) * dstSize.y;
+            if (view_distance_sq(dstRect.x + dstRect.w * pivot.x, dstRect.y + dstRect.h * pivot.y) >
+                reachX * reachX + reachY * reachY)
+            {
+                frame_stats.culled++;
+                return;
+            }
+        }
 
         const SDL_FRect dstSDLRect{
             static_cast<float>(dstRect.x),
@@ -65,11 +625,12 @@ namespace renderer
             static_cast<float>(dstRect.w),
             static_cast<float>(dstRect.h),
         };
+        const Rect srcRect = texture.getSourceRect();
         const SDL_FRect srcSDLRect{
-            static_cast<float>(clipArea.x),
-            static_cast<float>(clipArea.y),
-            static_cast<float>(clipArea.w),
-            static_cast<float>(clipArea.h),
+            static_cast<float>(srcRect.x),
+            static_cast<float>(srcRect.y),
+            static_cast<float>(srcRect.w),
+            static_cast<float>(srcRect.h),
         };
 
         // Pivot is normalized 0..1 relative to dstRect, for rotation center
@@ -84,9 +645,18 @@ namespace renderer
         if (texture.flip.v)
             flipAxis = static_cast<SDL_FlipMode>(flipAxis | SDL_FLIP_VERTICAL);
 
-        SDL_RenderTextureRotated(
-            _renderer, texture.getSDL(), &srcSDLRect, &dstSDLRect, TO_DEGREES(transform.rot),
-            &pivotPoint, flipAxis);
+        draw_queue.push_back({
+            layer,
+            static_cast<uint32_t>(draw_queue.size()),
+            texture.getShared(),
+            texture.getSDLBlendMode(),
+            flipAxis,
+            srcSDLRect,
+            dstSDLRect,
+            pivotPoint,
+            static_cast<float>(transform.rot - view.angle),
+            color,
+        });
     }
 
     void draw_batch_soa(
@@ -101,13 +671,480 @@ namespace renderer
         if (clipArea.w <= 1e-8 || clipArea.h <= 1e-8)
             return;
 
+        // Batches are drawn immediately, after everything queued before them
+        begin_draw();
+
+        const QuadParams params = quad_params(texture, anchor, pivot);
+
+        if (!culling)
+        {
+            size_t done = 0;
+            while (done < count && !geometry_unsupported)
+            {
+                size_t n = std::min(MAX_BATCH_QUADS, count - done);
+                batch_vertices.resize(n * 4);
+                jobs::parallelFor(n, BUILD_GRAIN, [&](size_t begin, size_t end)
+                                  { build_quads(
+                                        params,
+                                        pos_x + done + begin, pos_y + done + begin, rot + done + begin,
+                                        scale_x + done + begin, scale_y + done + begin,
+                                        end - begin, batch_vertices.data() + begin * 4); });
+
+                size_t drawn = draw_quads(texture, batch_vertices.data(), n);
+                done += drawn;
+                if (drawn < n)
+                    break;
+            }
+
+            if (done < count)
+            {
+                draw_batch_soa_rotated(
+                    texture,
+                    pos_x + done, pos_y + done, rot + done,
+                    scale_x + done, scale_y + done,
+                    count - done, anchor, pivot);
+            }
+            return;
+        }
+
+        // Cull in fixed groups of BUILD_GRAIN sprites so every group knows
+        // where its visible quads start, then build only those. Groups with
+        // nothing culled skip the index list.
+        const size_t groups = (count + BUILD_GRAIN - 1) / BUILD_GRAIN;
+        cull_indices.resize(count);
+        cull_counts.resize(groups + 1);
+        jobs::parallelFor(groups, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t g = begin; g < end; g++)
+            {
+                const size_t first = g * BUILD_GRAIN;
+                const size_t n = std::min(BUILD_GRAIN, count - first);
+                cull_counts[g] = cull_sprites(
+                    params,
+                    pos_x + first, pos_y + first, scale_x + first, scale_y + first,
+                    n, cull_indices.data() + first);
+            } });
+
+        // cull_counts becomes each group's offset, with the total at the end
+        size_t visible = 0;
+        for (size_t g = 0; g < groups; g++)
+        {
+            const size_t n = cull_counts[g];
+            cull_counts[g] = visible;
+            visible += n;
+        }
+        cull_counts[groups] = visible;
+        frame_stats.culled += count - visible;
+        if (visible == 0)
+            return;
+
+        batch_vertices.resize(visible * 4);
+        jobs::parallelFor(groups, 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t g = begin; g < end; g++)
+            {
+                const size_t first = g * BUILD_GRAIN;
+                const size_t n = cull_counts[g + 1] - cull_counts[g];
+                SDL_Vertex *out = batch_vertices.data() + cull_counts[g] * 4;
+                if (n == std::min(BUILD_GRAIN, count - first))
+                {
+                    build_quads(
+                        params,
+                        pos_x + first, pos_y + first, rot + first,
+                        scale_x + first, scale_y + first,
+                        n, out);
+                }
+                else
+                {
+                    build_quads_indexed(
+                        params, nullptr,
+                        pos_x + first, pos_y + first, rot + first,
+                        scale_x + first, scale_y + first,
+                        nullptr, cull_indices.data() + first, n, out);
+                }
+            } });
+
+        const size_t drawn = draw_quads(texture, batch_vertices.data(), visible);
+
+        // Per-sprite fallback for the visible sprites the renderer rejected
+        for (size_t g = 0; g < groups; g++)
+        {
+            const size_t first = g * BUILD_GRAIN;
+            for (size_t k = cull_counts[g]; k < cull_counts[g + 1]; k++)
+            {
+                if (k < drawn)
+                    continue;
+                const size_t n = cull_counts[g + 1] - cull_counts[g];
+                const size_t local = k - cull_counts[g];
+                const size_t i = first + (n == std::min(BUILD_GRAIN, count - first) ? local : cull_indices[first + local]);
+                draw_batch_soa_rotated(
+                    texture, pos_x + i, pos_y + i, rot + i, scale_x + i, scale_y + i,
+                    1, anchor, pivot);
+            }
+        }
+    }
+
+    QuadParams quad_params(const Texture &texture, const Vec2 &anchor, const Vec2 &pivot)
+    {
+        // UVs address the whole SDL texture, which may be a shared atlas page
+        const Rect src = texture.getSourceRect();
+        const float texW = static_cast<float>(texture.getSDLWidth());
+        const float texH = static_cast<float>(texture.getSDLHeight());
+
+        QuadParams params;
+        params.clipW = src.w;
+        params.clipH = src.h;
+        params.u0 = static_cast<float>(src.x) / texW;
+        params.u1 = static_cast<float>(src.x + src.w) / texW;
+        params.v0 = static_cast<float>(src.y) / texH;
+        params.v1 = static_cast<float>(src.y + src.h) / texH;
+        if (texture.flip.h)
+            std::swap(params.u0, params.u1);
+        if (texture.flip.v)
+            std::swap(params.v0, params.v1);
+        params.color = texture.getVertexColor();
+        params.anchor = anchor;
+        params.pivot = pivot;
+
+        const ViewTransform view = view_transform();
+        params.viewCos = view.cos;
+        params.viewSin = view.sin;
+        params.viewX = view.x;
+        params.viewY = view.y;
+        params.viewAngle = view.angle;
+        params.viewZoom = view.zoom;
+        return params;
+    }
+
+    // Shared body of the build_quads variants. With Frames, each sprite's
+    // size and UVs come from its frame instead of the params; with Indexed,
+    // quad i is built for sprite index[i] rather than sprite i.
+    template <bool Frames, bool Indexed>
+    static void build_quads_impl(
+        const QuadParams &params,
+        const FrameTable *frames,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        const double *frame,
+        const uint32_t *index,
+        size_t count,
+        SDL_Vertex *out)
+    {
+        double cw = params.clipW;
+        double ch = params.clipH;
+        float u0 = params.u0, u1 = params.u1;
+        float v0 = params.v0, v1 = params.v1;
+        const SDL_FColor color = params.color;
+        const Vec2 &anchor = params.anchor;
+        const Vec2 &pivot = params.pivot;
+
+        // Corner offsets relative to the pivot, as fractions of the dst size
+        const double left = -pivot.x;
+        const double right = 1.0 - pivot.x;
+        const double top = -pivot.y;
+        const double bottom = 1.0 - pivot.y;
+        const double pivotShiftX = pivot.x - anchor.x;
+        const double pivotShiftY = pivot.y - anchor.y;
+        const double viewCos = params.viewCos;
+        const double viewSin = params.viewSin;
+        const double viewX = params.viewX;
+        const double viewY = params.viewY;
+        const double viewAngle = params.viewAngle;
+        const double viewZoom = params.viewZoom;
+
+        // Work in tiles: a tight sin/cos pass that vectorizes, then assembly
+        constexpr size_t TILE = 256;
+        float sinBuf[TILE];
+        float cosBuf[TILE];
+
+        for (size_t base = 0; base < count; base += TILE)
+        {
+            const size_t n = std::min(TILE, count - base);
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const size_t j = Indexed ? index[base + i] : base + i;
+                fastmath::sincos(static_cast<float>(rot[j] - viewAngle), sinBuf[i], cosBuf[i]);
+            }
+
+            for (size_t i = 0; i < n; i++)
+            {
+                const size_t j = Indexed ? index[base + i] : base + i;
+
+                if constexpr (Frames)
+                {
+                    // Wrap into [0, frameCount); NaN fails the comparison
+                    // and lands on frame 0. Both compile to selects.
+                    const size_t frameCount = frames->count();
+                    const double total = static_cast<double>(frameCount);
+                    double f = frame[j] - total * std::floor(frame[j] / total);
+                    f = f >= 0.0 ? f : 0.0;
+                    const size_t k = std::min(static_cast<size_t>(f), frameCount - 1);
+
+                    cw = frames->size[k * 2];
+                    ch = frames->size[k * 2 + 1];
+                    u0 = frames->uv[k * 4];
+                    v0 = frames->uv[k * 4 + 1];
+                    u1 = frames->uv[k * 4 + 2];
+                    v1 = frames->uv[k * 4 + 3];
+                }
+
+                double dw = cw * scale_x[j];
+                double dh = ch * scale_y[j];
+
+                // Rotation center in the world, then through the camera
+                const double wx = pos_x[j] + dw * pivotShiftX;
+                const double wy = pos_y[j] + dh * pivotShiftY;
+                const float cx = static_cast<float>(viewCos * wx + viewSin * wy + viewX);
+                const float cy = static_cast<float>(-viewSin * wx + viewCos * wy + viewY);
+                dw *= viewZoom;
+                dh *= viewZoom;
+
+                const float x0 = static_cast<float>(dw * left);
+                const float x1 = static_cast<float>(dw * right);
+                const float y0 = static_cast<float>(dh * top);
+                const float y1 = static_cast<float>(dh * bottom);
+
+                const float s = sinBuf[i];
+                const float c = cosBuf[i];
+
+                SDL_Vertex *v = out + (base + i) * 4;
+                v[0] = {{c * x0 - s * y0 + cx, s * x0 + c * y0 + cy}, color, {u0, v0}};
+                v[1] = {{c * x1 - s * y0 + cx, s * x1 + c * y0 + cy}, color, {u1, v0}};
+                v[2] = {{c * x1 - s * y1 + cx, s * x1 + c * y1 + cy}, color, {u1, v1}};
+                v[3] = {{c * x0 - s * y1 + cx, s * x0 + c * y1 + cy}, color, {u0, v1}};
+            }
+        }
+    }
+
+    void build_quads(
+        const QuadParams &params,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        SDL_Vertex *out)
+    {
+        build_quads_impl<false, false>(params, nullptr, pos_x, pos_y, rot, scale_x, scale_y, nullptr, nullptr, count, out);
+    }
+
+    void build_quads(
+        const QuadParams &params,
+        const FrameTable &frames,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        const double *frame,
+        size_t count,
+        SDL_Vertex *out)
+    {
+        build_quads_impl<true, false>(params, &frames, pos_x, pos_y, rot, scale_x, scale_y, frame, nullptr, count, out);
+    }
+
+    void build_quads_indexed(
+        const QuadParams &params,
+        const FrameTable *frames,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        const double *frame,
+        const uint32_t *indices,
+        size_t count,
+        SDL_Vertex *out)
+    {
+        if (frames)
+            build_quads_impl<true, true>(params, frames, pos_x, pos_y, rot, scale_x, scale_y, frame, indices, count, out);
+        else
+            build_quads_impl<false, true>(params, nullptr, pos_x, pos_y, rot, scale_x, scale_y, nullptr, indices, count, out);
+    }
+
+    size_t cull_sprites(
+        const QuadParams &params,
+        const double *pos_x, const double *pos_y,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        uint32_t *out)
+    {
+        const double cw = params.clipW;
+        const double ch = params.clipH;
+        const Vec2 &pivot = params.pivot;
+        const double pivotShiftX = pivot.x - params.anchor.x;
+        const double pivotShiftY = pivot.y - params.anchor.y;
+
+        const double viewCos = params.viewCos;
+        const double viewSin = params.viewSin;
+        const double viewX = params.viewX;
+        const double viewY = params.viewY;
+
+        // The farthest corner from the rotation center bounds every rotation
+        const double reachX = std::max(pivot.x, 1.0 - pivot.x) * cw * params.viewZoom;
+        const double reachY = std::max(pivot.y, 1.0 - pivot.y) * ch * params.viewZoom;
+
+        auto isVisible = [&](size_t i)
+        {
+            const double wx = pos_x[i] + cw * scale_x[i] * pivotShiftX;
+            const double wy = pos_y[i] + ch * scale_y[i] * pivotShiftY;
+            const double cx = viewCos * wx + viewSin * wy + viewX;
+            const double cy = -viewSin * wx + viewCos * wy + viewY;
+            const double rx = reachX * scale_x[i];
+            const double ry = reachY * scale_y[i];
+            return view_distance_sq(cx, cy) <= rx * rx + ry * ry;
+        };
+
+        // Counting pass first: it has no stores, and when everything is on
+        // screen it is the only pass
+        size_t visible = 0;
+        for (size_t i = 0; i < count; i++)
+            visible += isVisible(i);
+        if (visible == count)
+            return count;
+
+        // The index is always written and the count advanced by the test
+        // result, so the loop has no branches
+        visible = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            out[visible] = static_cast<uint32_t>(i);
+            visible += isVisible(i);
+        }
+        return visible;
+    }
+
+    void frame_table(const Texture &texture, FrameTable &out)
+    {
+        const float texW = static_cast<float>(texture.getSDLWidth());
+        const float texH = static_cast<float>(texture.getSDLHeight());
+        const Rect region = texture.getRegion();
+
+        const std::vector<Rect> &frames = texture.getFrames();
+        const size_t count = frames.empty() ? 1 : frames.size();
+        out.uv.resize(count * 4);
+        out.size.resize(count * 2);
+
+        for (size_t k = 0; k < count; k++)
+        {
+            // Frames are relative to the texture's region, like the clip area
+            Rect src = texture.getSourceRect();
+            if (!frames.empty())
+                src = {frames[k].x + region.x, frames[k].y + region.y, frames[k].w, frames[k].h};
+
+            float u0 = static_cast<float>(src.x) / texW;
+            float u1 = static_cast<float>(src.x + src.w) / texW;
+            float v0 = static_cast<float>(src.y) / texH;
+            float v1 = static_cast<float>(src.y + src.h) / texH;
+            if (texture.flip.h)
+                std::swap(u0, u1);
+            if (texture.flip.v)
+                std::swap(v0, v1);
+
+            out.uv[k * 4] = u0;
+            out.uv[k * 4 + 1] = v0;
+            out.uv[k * 4 + 2] = u1;
+            out.uv[k * 4 + 3] = v1;
+            out.size[k * 2] = src.w;
+            out.size[k * 2 + 1] = src.h;
+        }
+    }
+
+    void tint_quads(
+        const double *r, const double *g, const double *b, const double *a,
+        size_t count,
+        SDL_Vertex *out)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const float tr = static_cast<float>(std::clamp(r[i], 0.0, 1.0));
+            const float tg = static_cast<float>(std::clamp(g[i], 0.0, 1.0));
+            const float tb = static_cast<float>(std::clamp(b[i], 0.0, 1.0));
+            const float ta = static_cast<float>(std::clamp(a[i], 0.0, 1.0));
+
+            SDL_Vertex *v = out + i * 4;
+            for (int k = 0; k < 4; k++)
+            {
+                v[k].color.r *= tr;
+                v[k].color.g *= tg;
+                v[k].color.b *= tb;
+                v[k].color.a *= ta;
+            }
+        }
+    }
+
+    size_t draw_quads(const Texture &texture, const SDL_Vertex *vertices, size_t quadCount)
+    {
+        begin_draw();
         SDL_Texture *sdlTex = texture.getSDL();
+        set_texture_blend(sdlTex, texture_state(sdlTex), texture.getSDLBlendMode());
+        return submit_quads(sdlTex, vertices, quadCount);
+    }
+
+    size_t draw_colored_quads(const SDL_Vertex *vertices, size_t quadCount)
+    {
+        begin_draw();
+        return submit_quads(nullptr, vertices, quadCount);
+    }
+
+    void draw_points(const SDL_FPoint *points, size_t count, const SDL_FColor &color)
+    {
+        begin_draw();
+        set_draw_color(color);
+
+        // SDL takes an int count
+        constexpr size_t MAX_POINTS = size_t{1} << 24;
+        for (size_t done = 0; done < count; done += MAX_POINTS)
+        {
+            const size_t n = std::min(MAX_POINTS, count - done);
+            SDL_RenderPoints(_renderer, points + done, static_cast<int>(n));
+            count_submit(nullptr, n, n);
+        }
+    }
+
+    void draw_screen(const Texture &texture, const Rect &dst)
+    {
+        begin_draw();
+
+        SDL_Texture *sdlTex = texture.getSDL();
+        TextureState &state = texture_state(sdlTex);
+        set_texture_blend(sdlTex, state, texture.getSDLBlendMode());
+        set_texture_mods(sdlTex, state, texture.getVertexColor());
+
+        const Rect src = texture.getSourceRect();
+        const SDL_FRect srcRect{
+            static_cast<float>(src.x), static_cast<float>(src.y),
+            static_cast<float>(src.w), static_cast<float>(src.h)};
+        const SDL_FRect dstRect{
+            static_cast<float>(dst.x), static_cast<float>(dst.y),
+            static_cast<float>(dst.w), static_cast<float>(dst.h)};
+        SDL_RenderTexture(_renderer, sdlTex, &srcRect, &dstRect);
+        count_submit(sdlTex, 1, 0);
+    }
+
+    void draw_batch_soa_rotated(
+        const Texture &texture,
+        const double *pos_x, const double *pos_y,
+        const double *rot,
+        const double *scale_x, const double *scale_y,
+        size_t count,
+        const Vec2 &anchor, const Vec2 &pivot)
+    {
+        Rect clipArea = texture.getClipArea();
+        if (clipArea.w <= 1e-8 || clipArea.h <= 1e-8)
+            return;
+
+        begin_draw();
+
+        // The texture's own state; it may share its SDL texture with others
+        SDL_Texture *sdlTex = texture.getSDL();
+        TextureState &state = texture_state(sdlTex);
+        set_texture_blend(sdlTex, state, texture.getSDLBlendMode());
+        set_texture_mods(sdlTex, state, texture.getVertexColor());
 
+        const Rect srcRect = texture.getSourceRect();
         const SDL_FRect srcSDLRect{
-            static_cast<float>(clipArea.x),
-            static_cast<float>(clipArea.y),
-            static_cast<float>(clipArea.w),
-            static_cast<float>(clipArea.h),
+            static_cast<float>(srcRect.x),
+            static_cast<float>(srcRect.y),
+            static_cast<float>(srcRect.w),
+            static_cast<float>(srcRect.h),
         };
 
         SDL_FlipMode flipAxis = SDL_FLIP_NONE;
@@ -116,18 +1153,36 @@ namespace renderer
         if (texture.flip.v)
             flipAxis = static_cast<SDL_FlipMode>(flipAxis | SDL_FLIP_VERTICAL);
 
+        const ViewTransform view = view_transform();
         const double cw = clipArea.w;
         const double ch = clipArea.h;
+        const double reachX = std::max(pivot.x, 1.0 - pivot.x) * cw * view.zoom;
+        const double reachY = std::max(pivot.y, 1.0 - pivot.y) * ch * view.zoom;
 
         for (size_t i = 0; i < count; ++i)
         {
             double sx = scale_x[i];
             double sy = scale_y[i];
 
-            double dw = cw * sx;
-            double dh = ch * sy;
-            double dx = pos_x[i] - dw * anchor.x;
-            double dy = pos_y[i] - dh * anchor.y;
+            // Rotation center in the world, through the camera, then the
+            // zoomed rect around it
+            const double wx = pos_x[i] + cw * sx * (pivot.x - anchor.x);
+            const double wy = pos_y[i] + ch * sy * (pivot.y - anchor.y);
+            double dw = cw * sx * view.zoom;
+            double dh = ch * sy * view.zoom;
+            double dx = view.mapX(wx, wy) - dw * pivot.x;
+            double dy = view.mapY(wx, wy) - dh * pivot.y;
+
+            if (culling)
+            {
+                const double rx = reachX * sx;
+                const double ry = reachY * sy;
+                if (view_distance_sq(dx + dw * pivot.x, dy + dh * pivot.y) > rx * rx + ry * ry)
+                {
+                    frame_stats.culled++;
+                    continue;
+                }
+            }
 
             const SDL_FRect dstSDLRect{
                 static_cast<float>(dx),
@@ -142,14 +1197,46 @@ namespace renderer
             };
 
             SDL_RenderTextureRotated(
-                _renderer, sdlTex, &srcSDLRect, &dstSDLRect, TO_DEGREES(rot[i]),
+                _renderer, sdlTex, &srcSDLRect, &dstSDLRect, TO_DEGREES(rot[i] - view.angle),
                 &pivotPoint, flipAxis);
+            count_submit(sdlTex, 1, 0);
+        }
+    }
+
+    std::vector<uint8_t> read_pixels(int &width, int &height)
+    {
+        flush();
+
+        SDL_Surface *surface = SDL_RenderReadPixels(_renderer, nullptr);
+        if (!surface)
+            throw std::runtime_error("Failed to read pixels: " + std::string(SDL_GetError()));
+        if (surface->format != SDL_PIXELFORMAT_RGBA32)
+        {
+            SDL_Surface *converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+            SDL_DestroySurface(surface);
+            if (!converted)
+                throw std::runtime_error("Failed to convert pixels: " + std::string(SDL_GetError()));
+            surface = converted;
+        }
+
+        width = surface->w;
+        height = surface->h;
+        const size_t row = static_cast<size_t>(width) * 4;
+        std::vector<uint8_t> pixels(row * height);
+        for (int y = 0; y < height; y++)
+        {
+            const uint8_t *src = static_cast<const uint8_t *>(surface->pixels) + static_cast<size_t>(y) * surface->pitch;
+            std::copy_n(src, row, pixels.data() + y * row);
         }
+        SDL_DestroySurface(surface);
+        return pixels;
     }
 
-    void _init(SDL_Window *window, const int width, const int height)
+    void _init(SDL_Window *window, const int width, const int height, bool software)
     {
-        _renderer = SDL_CreateGPURenderer(nullptr, window);
+        // Headless runs draw on the CPU into the hidden window's surface
+        _renderer = software ? SDL_CreateRenderer(window, SDL_SOFTWARE_RENDERER)
+                             : SDL_CreateGPURenderer(nullptr, window);
         if (_renderer == nullptr)
             throw std::runtime_error("Renderer failed to create: " + std::string(SDL_GetError()));
 
@@ -159,6 +1246,12 @@ namespace renderer
 
     void _quit()
     {
+        draw_queue.clear();
+        texture_states.clear();
+        draw_color = {-1.0f, -1.0f, -1.0f, -1.0f};
+        current_target = nullptr;
+        bound_texture = nullptr;
+        view_size_dirty = true;
         if (_renderer)
         {
             SDL_DestroyRenderer(_renderer);
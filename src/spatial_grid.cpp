@@ -0,0 +1,113 @@
+#include "SpatialGrid.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "ChunkedSoA.hpp"
+#include "Jobs.hpp"
+
+void SpatialGrid::configure(const Rect &bounds, double cellSize)
+{
+    if (cellSize <= 0.0)
+        throw std::invalid_argument("SpatialGrid: cell size must be positive");
+
+    double cols = std::max(1.0, std::ceil(bounds.w / cellSize));
+    double rows = std::max(1.0, std::ceil(bounds.h / cellSize));
+    if (cols * rows > static_cast<double>(MAX_CELLS))
+        throw std::invalid_argument("SpatialGrid: cell size too small for bounds");
+
+    m_bounds = bounds;
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0 / cellSize;
+    m_cols = static_cast<int>(cols);
+    m_rows = static_cast<int>(rows);
+    m_indices.clear();
+}
+
+void SpatialGrid::rebuild(const ChunkedSoA &data, size_t colX, size_t colY,
+                          const std::vector<size_t> &payload)
+{
+    const size_t count = data.size();
+    const size_t cells = static_cast<size_t>(m_cols) * m_rows;
+
+    m_cellOf.resize(count);
+    m_indices.resize(count);
+    m_sortedX.resize(count);
+    m_sortedY.resize(count);
+    m_payload.resize(payload.size());
+    for (auto &column : m_payload)
+        column.resize(count);
+
+    // 1. Cell assignment, one block per task
+    jobs::parallelFor(data.blockCount(), 8, [&](size_t begin, size_t end)
+                      {
+        for (size_t b = begin; b < end; b++)
+        {
+            const double *xs = data.column(b, colX);
+            const double *ys = data.column(b, colY);
+            uint32_t *cellOf = m_cellOf.data() + b * ChunkedSoA::BLOCK_SIZE;
+            size_t n = data.blockSize(b);
+            for (size_t i = 0; i < n; i++)
+                cellOf[i] = static_cast<uint32_t>(cellY(ys[i]) * m_cols + cellX(xs[i]));
+        } });
+
+    // 2. Histogram + exclusive prefix sum
+    m_cellStart.assign(cells + 1, 0);
+    for (size_t i = 0; i < count; i++)
+        m_cellStart[m_cellOf[i] + 1]++;
+    for (size_t c = 0; c < cells; c++)
+        m_cellStart[c + 1] += m_cellStart[c];
+
+    // 3. Scatter into cell order (stable, so ties keep index order)
+    m_cursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (size_t b = 0; b < data.blockCount(); b++)
+    {
+        const double *xs = data.column(b, colX);
+        const double *ys = data.column(b, colY);
+        size_t base = b * ChunkedSoA::BLOCK_SIZE;
+        size_t n = data.blockSize(b);
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t slot = m_cursor[m_cellOf[base + i]]++;
+            m_cellOf[base + i] = slot; // reused below as index -> slot
+            m_indices[slot] = static_cast<uint32_t>(base + i);
+            m_sortedX[slot] = xs[i];
+            m_sortedY[slot] = ys[i];
+        }
+
+        for (size_t p = 0; p < payload.size(); p++)
+        {
+            const double *src = data.column(b, payload[p]);
+            double *dst = m_payload[p].data();
+            for (size_t i = 0; i < n; i++)
+                dst[m_cellOf[base + i]] = src[i];
+        }
+    }
+}
+
+void SpatialGrid::queryRadius(double x, double y, double radius, std::vector<uint32_t> &out) const
+{
+    const double r2 = radius * radius;
+    forEachCandidate(x - radius, y - radius, x + radius, y + radius,
+                     [&](size_t slot)
+                     {
+                         double dx = m_sortedX[slot] - x;
+                         double dy = m_sortedY[slot] - y;
+                         if (dx * dx + dy * dy <= r2)
+                             out.push_back(m_indices[slot]);
+                     });
+}
+
+void SpatialGrid::queryRect(const Rect &rect, std::vector<uint32_t> &out) const
+{
+    const double x1 = rect.x + rect.w;
+    const double y1 = rect.y + rect.h;
+    forEachCandidate(rect.x, rect.y, x1, y1,
+                     [&](size_t slot)
+                     {
+                         double px = m_sortedX[slot];
+                         double py = m_sortedY[slot];
+                         if (px >= rect.x && px <= x1 && py >= rect.y && py <= y1)
+                             out.push_back(m_indices[slot]);
+                     });
+}
@@ -1,51 +1,115 @@
 #include "Texture.hpp"
 
 #include "Renderer.hpp"
+#include "TextureCache.hpp"
 
 Texture::Texture(const std::string &filePath)
+    : Texture(textures::acquire(filePath))
 {
-    if (filePath.empty())
-        throw std::invalid_argument("File path cannot be empty");
+}
 
-    SDL_Surface *surface = SDL_LoadPNG(filePath.c_str());
-    if (!surface)
-        throw std::runtime_error("Failed to load image: " + std::string(SDL_GetError()));
+Texture::Texture(std::shared_ptr<SDL_Texture> texture)
+    : m_texture(std::move(texture))
+{
+    if (!m_texture)
+        throw std::invalid_argument("Texture needs a texture");
 
-    m_texture = SDL_CreateTextureFromSurface(renderer::_get(), surface);
-    SDL_DestroySurface(surface);
+    initFromSDL();
+    m_region = {0, 0, m_sdlWidth, m_sdlHeight};
+    m_width = m_sdlWidth;
+    m_height = m_sdlHeight;
+    m_clipArea = {0, 0, m_width, m_height};
+}
+
+Texture::Texture(std::shared_ptr<SDL_Texture> texture, const Rect &region)
+    : m_texture(std::move(texture)), m_region(region)
+{
     if (!m_texture)
+        throw std::invalid_argument("Texture region needs a texture");
+
+    initFromSDL();
+    m_width = static_cast<int>(region.w);
+    m_height = static_cast<int>(region.h);
+    m_clipArea = {0, 0, m_width, m_height};
+}
+
+std::shared_ptr<SDL_Texture> Texture::share(SDL_Texture *texture)
+{
+    if (!texture)
         throw std::runtime_error("Failed to load texture: " + std::string(SDL_GetError()));
+    return std::shared_ptr<SDL_Texture>(texture, [](SDL_Texture *texture)
+                                        {
+        renderer::_forget_texture(texture);
+        SDL_DestroyTexture(texture); });
+}
 
+void Texture::initFromSDL()
+{
     float w, h;
-    if (!SDL_GetTextureSize(m_texture, &w, &h))
-    {
-        SDL_DestroyTexture(m_texture);
-        m_texture = nullptr;
+    if (!SDL_GetTextureSize(m_texture.get(), &w, &h))
         throw std::runtime_error("Failed to get texture size: " + std::string(SDL_GetError()));
-    }
 
-    m_width = static_cast<int>(w);
-    m_height = static_cast<int>(h);
-    m_clipArea = {0, 0, m_width, m_height};
+    m_sdlWidth = static_cast<int>(w);
+    m_sdlHeight = static_cast<int>(h);
 }
 
-Texture::~Texture()
+void Texture::setFrameGrid(int columns, int rows, int count)
 {
-    if (m_texture)
+    if (columns <= 0 || rows <= 0)
+        throw std::invalid_argument("Frame grid needs at least one column and one row");
+    if (count < 0 || count > columns * rows)
+        throw std::invalid_argument("Frame count must be between 0 and columns * rows");
+
+    const int frameW = m_width / columns;
+    const int frameH = m_height / rows;
+    if (frameW == 0 || frameH == 0)
+        throw std::invalid_argument("Frame grid is finer than the texture");
+
+    std::vector<Rect> frames;
+    frames.reserve(count ? count : columns * rows);
+    for (int row = 0; row < rows; row++)
     {
-        SDL_DestroyTexture(m_texture);
-        m_texture = nullptr;
+        for (int column = 0; column < columns; column++)
+            frames.emplace_back(column * frameW, row * frameH, frameW, frameH);
     }
+    if (count)
+        frames.resize(count);
+
+    setFrames(frames);
 }
 
-void Texture::setAlpha(const float alpha) const
+void Texture::setFrames(const std::vector<Rect> &frames)
 {
-    SDL_SetTextureAlphaModFloat(m_texture, alpha);
+    if (frames.empty())
+        throw std::invalid_argument("Texture needs at least one frame");
+
+    m_frames = frames;
+    m_clipArea = m_frames[0];
 }
 
-float Texture::getAlpha() const
+void Texture::setFrame(size_t index)
 {
-    float alphaMod;
-    SDL_GetTextureAlphaModFloat(m_texture, &alphaMod);
-    return alphaMod;
+    if (m_frames.empty())
+        throw std::runtime_error("Texture has no frames");
+
+    m_clipArea = m_frames[index % m_frames.size()];
+}
+
+SDL_BlendMode Texture::getSDLBlendMode() const
+{
+    switch (m_blendMode)
+    {
+    case BlendMode::NONE:
+        return SDL_BLENDMODE_NONE;
+    case BlendMode::ADD:
+        return SDL_BLENDMODE_ADD;
+    case BlendMode::MOD:
+        return SDL_BLENDMODE_MOD;
+    case BlendMode::MUL:
+        return SDL_BLENDMODE_MUL;
+    case BlendMode::PREMULTIPLIED:
+        return SDL_BLENDMODE_BLEND_PREMULTIPLIED;
+    default:
+        return SDL_BLENDMODE_BLEND;
+    }
 }
@@ -0,0 +1,344 @@
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "Renderer.hpp"
+
+namespace fs = std::filesystem;
+
+using SurfacePtr = std::unique_ptr<SDL_Surface, decltype(&SDL_DestroySurface)>;
+
+constexpr const char *INDEX_MAGIC = "goob-atlas";
+constexpr int INDEX_VERSION = 1;
+
+namespace
+{
+// Bottom-left skyline packer for a single page
+class Skyline
+{
+public:
+    Skyline(int width, int height) : m_width(width), m_height(height), m_nodes{{0, 0, width}} {}
+
+    bool insert(int w, int h, int &outX, int &outY)
+    {
+        // Lowest placement wins; ties go to the narrowest segment
+        size_t best = SIZE_MAX;
+        int bestY = INT_MAX;
+        int bestW = INT_MAX;
+        for (size_t i = 0; i < m_nodes.size(); i++)
+        {
+            int y;
+            if (fits(i, w, h, y) && (y < bestY || (y == bestY && m_nodes[i].w < bestW)))
+            {
+                best = i;
+                bestY = y;
+                bestW = m_nodes[i].w;
+            }
+        }
+        if (best == SIZE_MAX)
+            return false;
+
+        outX = m_nodes[best].x;
+        outY = bestY;
+        m_nodes.insert(m_nodes.begin() + best, {outX, outY + h, w});
+
+        // Trim or drop the segments now covered by the new one
+        for (size_t i = best + 1; i < m_nodes.size();)
+        {
+            const Node &prev = m_nodes[i - 1];
+            Node &cur = m_nodes[i];
+            const int overlap = prev.x + prev.w - cur.x;
+            if (overlap <= 0)
+                break;
+            cur.x += overlap;
+            cur.w -= overlap;
+            if (cur.w > 0)
+                break;
+            m_nodes.erase(m_nodes.begin() + i);
+        }
+
+        // Merge neighbors at the same height
+        for (size_t i = 0; i + 1 < m_nodes.size();)
+        {
+            if (m_nodes[i].y == m_nodes[i + 1].y)
+            {
+                m_nodes[i].w += m_nodes[i + 1].w;
+                m_nodes.erase(m_nodes.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
+
+        m_usedW = std::max(m_usedW, outX + w);
+        m_usedH = std::max(m_usedH, outY + h);
+        return true;
+    }
+
+    int usedWidth() const { return m_usedW; }
+    int usedHeight() const { return m_usedH; }
+
+private:
+    struct Node
+    {
+        int x, y, w;
+    };
+
+    // Height at which a w x h rect starting at node `index` would rest
+    bool fits(size_t index, int w, int h, int &y) const
+    {
+        if (m_nodes[index].x + w > m_width)
+            return false;
+
+        y = m_nodes[index].y;
+        int remaining = w;
+        for (size_t i = index; remaining > 0; i++)
+        {
+            if (i >= m_nodes.size())
+                return false;
+            y = std::max(y, m_nodes[i].y);
+            if (y + h > m_height)
+                return false;
+            remaining -= m_nodes[i].w;
+        }
+        return true;
+    }
+
+    int m_width;
+    int m_height;
+    int m_usedW{0};
+    int m_usedH{0};
+    std::vector<Node> m_nodes;
+};
+}
+
+static std::string pageFile(const std::string &cachePath, size_t page)
+{
+    return cachePath + "." + std::to_string(page) + ".png";
+}
+
+TextureAtlas::TextureAtlas(const std::vector<std::string> &paths, int pageSize, int padding,
+                           const std::string &cachePath)
+    : m_pageSize(pageSize), m_padding(padding)
+{
+    if (pageSize <= 0)
+        throw std::invalid_argument("Atlas page size must be positive");
+    if (padding < 0)
+        throw std::invalid_argument("Atlas padding cannot be negative");
+
+    std::vector<Source> sources;
+    for (const auto &path : paths)
+    {
+        auto same = [&](const Source &source)
+        { return source.path == path; };
+        if (std::any_of(sources.begin(), sources.end(), same))
+            continue;
+
+        std::error_code sizeError, timeError;
+        const auto size = fs::file_size(path, sizeError);
+        const auto modified = fs::last_write_time(path, timeError);
+        if (sizeError || timeError)
+            throw std::runtime_error("Failed to load image: " + path);
+        sources.push_back({path, static_cast<long long>(modified.time_since_epoch().count()), size});
+    }
+
+    if (!cachePath.empty() && loadCache(cachePath, sources))
+    {
+        m_fromCache = true;
+        return;
+    }
+    pack(sources, cachePath);
+}
+
+void TextureAtlas::pack(const std::vector<Source> &sources, const std::string &cachePath)
+{
+    // Decode everything up front as RGBA
+    std::vector<SurfacePtr> images;
+    images.reserve(sources.size());
+    for (const auto &source : sources)
+    {
+        SurfacePtr loaded(SDL_LoadPNG(source.path.c_str()), SDL_DestroySurface);
+        if (!loaded)
+            throw std::runtime_error("Failed to load image: " + std::string(SDL_GetError()));
+
+        SurfacePtr rgba(SDL_ConvertSurface(loaded.get(), SDL_PIXELFORMAT_RGBA32), SDL_DestroySurface);
+        if (!rgba)
+            throw std::runtime_error("Failed to convert image: " + std::string(SDL_GetError()));
+
+        if (rgba->w > m_pageSize || rgba->h > m_pageSize)
+            throw std::invalid_argument("Image larger than atlas page: " + source.path);
+        images.push_back(std::move(rgba));
+    }
+
+    // Tallest first packs a skyline tightest
+    std::vector<size_t> order(sources.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+              {
+        if (images[a]->h != images[b]->h)
+            return images[a]->h > images[b]->h;
+        return images[a]->w > images[b]->w; });
+
+    // Padding sits right and below each image, so a page may overhang by it
+    std::vector<Skyline> skylines;
+    std::vector<Entry> placed(sources.size());
+    for (size_t i : order)
+    {
+        const int w = images[i]->w + m_padding;
+        const int h = images[i]->h + m_padding;
+        const int extent = m_pageSize + m_padding;
+
+        int x = 0, y = 0;
+        size_t page = 0;
+        while (page < skylines.size() && !skylines[page].insert(w, h, x, y))
+            page++;
+        if (page == skylines.size())
+        {
+            skylines.emplace_back(extent, extent);
+            skylines.back().insert(w, h, x, y);
+        }
+        placed[i] = {page, Rect(x, y, images[i]->w, images[i]->h)};
+    }
+
+    // Compose pages trimmed to their used area, then upload
+    std::vector<SurfacePtr> pages;
+    for (const auto &skyline : skylines)
+    {
+        const int w = std::min(skyline.usedWidth(), m_pageSize);
+        const int h = std::min(skyline.usedHeight(), m_pageSize);
+        SurfacePtr page(SDL_CreateSurface(w, h, SDL_PIXELFORMAT_RGBA32), SDL_DestroySurface);
+        if (!page)
+            throw std::runtime_error("Failed to create atlas page: " + std::string(SDL_GetError()));
+        pages.push_back(std::move(page));
+    }
+
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        const Entry &entry = placed[i];
+        SDL_Rect dst{static_cast<int>(entry.region.x), static_cast<int>(entry.region.y),
+                     images[i]->w, images[i]->h};
+        SDL_SetSurfaceBlendMode(images[i].get(), SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(images[i].get(), nullptr, pages[entry.page].get(), &dst);
+        m_entries[sources[i].path] = entry;
+    }
+
+    std::vector<SDL_Surface *> pageSurfaces;
+    for (const auto &page : pages)
+    {
+        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer::_get(), page.get());
+        if (!texture)
+            throw std::runtime_error("Failed to create atlas page: " + std::string(SDL_GetError()));
+        m_pages.push_back(Texture::share(texture));
+        pageSurfaces.push_back(page.get());
+    }
+
+    if (!cachePath.empty())
+        saveCache(cachePath, sources, pageSurfaces);
+}
+
+bool TextureAtlas::loadCache(const std::string &cachePath, const std::vector<Source> &sources)
+{
+    std::ifstream index(cachePath);
+    if (!index.is_open())
+        return false;
+
+    std::string magic;
+    int version = 0, pageSize = 0, padding = 0;
+    size_t pageCount = 0, imageCount = 0;
+    if (!(index >> magic >> version >> pageSize >> padding >> pageCount >> imageCount) ||
+        magic != INDEX_MAGIC || version != INDEX_VERSION ||
+        pageSize != m_pageSize || padding != m_padding || imageCount != sources.size())
+        return false;
+
+    // One line per image: page x y w h size modified path
+    std::unordered_map<std::string, Entry> entries;
+    for (size_t i = 0; i < imageCount; i++)
+    {
+        Entry entry;
+        double x, y, w, h;
+        unsigned long long size;
+        long long modified;
+        std::string path;
+        if (!(index >> entry.page >> x >> y >> w >> h >> size >> modified))
+            return false;
+        index.get();
+        if (!std::getline(index, path) || entry.page >= pageCount)
+            return false;
+
+        auto same = [&](const Source &source)
+        { return source.path == path && source.size == size && source.modified == modified; };
+        if (std::none_of(sources.begin(), sources.end(), same))
+            return false;
+
+        entry.region = {x, y, w, h};
+        entries[path] = entry;
+    }
+    if (entries.size() != sources.size())
+        return false;
+
+    std::vector<std::shared_ptr<SDL_Texture>> pages;
+    for (size_t p = 0; p < pageCount; p++)
+    {
+        SurfacePtr page(SDL_LoadPNG(pageFile(cachePath, p).c_str()), SDL_DestroySurface);
+        if (!page)
+            return false;
+        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer::_get(), page.get());
+        if (!texture)
+            throw std::runtime_error("Failed to create atlas page: " + std::string(SDL_GetError()));
+        pages.push_back(Texture::share(texture));
+    }
+
+    m_pages = std::move(pages);
+    m_entries = std::move(entries);
+    return true;
+}
+
+void TextureAtlas::saveCache(const std::string &cachePath, const std::vector<Source> &sources,
+                             const std::vector<SDL_Surface *> &pages) const
+{
+    for (size_t p = 0; p < pages.size(); p++)
+    {
+        if (!SDL_SavePNG(pages[p], pageFile(cachePath, p).c_str()))
+            throw std::runtime_error("Failed to save atlas page: " + std::string(SDL_GetError()));
+    }
+
+    std::ofstream index(cachePath, std::ios::trunc);
+    if (!index.is_open())
+        throw std::runtime_error("Failed to write atlas index: " + cachePath);
+
+    index << INDEX_MAGIC << ' ' << INDEX_VERSION << ' ' << m_pageSize << ' ' << m_padding << ' '
+          << pages.size() << ' ' << sources.size() << '\n';
+    for (const auto &source : sources)
+    {
+        const Entry &entry = m_entries.at(source.path);
+        index << entry.page << ' '
+              << entry.region.x << ' ' << entry.region.y << ' '
+              << entry.region.w << ' ' << entry.region.h << ' '
+              << source.size << ' ' << source.modified << ' '
+              << source.path << '\n';
+    }
+}
+
+Texture TextureAtlas::get(const std::string &path) const
+{
+    auto it = m_entries.find(path);
+    if (it == m_entries.end())
+        throw std::invalid_argument("Image not in atlas: " + path);
+    return Texture(m_pages[it->second.page], it->second.region);
+}
+
+std::vector<std::string> TextureAtlas::getPaths() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(m_entries.size());
+    for (const auto &[path, entry] : m_entries)
+        paths.push_back(path);
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
@@ -0,0 +1,290 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "Jobs.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+namespace textures
+{
+    struct LoadState
+    {
+        std::string path;
+
+        // Written by the decoding worker
+        std::mutex mutex;
+        std::condition_variable decodedCv;
+        bool decoded{false};
+        SDL_Surface *surface{nullptr};
+        std::string error;
+
+        // Render thread only
+        bool done{false};
+        std::shared_ptr<SDL_Texture> texture;
+        std::weak_ptr<void> interest; // see Request::m_interest
+    };
+
+    // Render-thread state
+    static std::unordered_map<std::string, std::weak_ptr<SDL_Texture>> _cache;
+    static std::deque<std::shared_ptr<LoadState>> _pending;
+    static double _uploadBudgetMs = 2.0;
+
+    static void decode(const std::shared_ptr<LoadState> &state)
+    {
+        SDL_Surface *surface = SDL_LoadPNG(state->path.c_str());
+
+        std::lock_guard lock(state->mutex);
+        if (surface)
+            state->surface = surface;
+        else
+            state->error = "Failed to load image: " + std::string(SDL_GetError());
+        state->decoded = true;
+        state->decodedCv.notify_all();
+    }
+
+    // Upload a decoded image and publish it in the cache
+    static void finish(LoadState &state)
+    {
+        if (state.done)
+            return;
+
+        {
+            std::unique_lock lock(state.mutex);
+            state.decodedCv.wait(lock, [&]
+                                 { return state.decoded; });
+        }
+
+        if (state.surface)
+        {
+            SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer::_get(), state.surface);
+            SDL_DestroySurface(state.surface);
+            state.surface = nullptr;
+
+            if (texture)
+            {
+                state.texture = Texture::share(texture);
+                _cache[state.path] = state.texture;
+            }
+            else
+            {
+                state.error = "Failed to load texture: " + std::string(SDL_GetError());
+            }
+        }
+        state.done = true;
+    }
+
+    static void removePending(const LoadState &state)
+    {
+        auto it = std::find_if(_pending.begin(), _pending.end(), [&](const auto &pending)
+                               { return pending.get() == &state; });
+        if (it != _pending.end())
+            _pending.erase(it);
+    }
+
+    static std::shared_ptr<LoadState> findPending(const std::string &path)
+    {
+        for (const auto &state : _pending)
+        {
+            if (state->path == path)
+                return state;
+        }
+        return nullptr;
+    }
+
+    static std::shared_ptr<SDL_Texture> findCached(const std::string &path)
+    {
+        auto it = _cache.find(path);
+        if (it == _cache.end())
+            return nullptr;
+
+        auto texture = it->second.lock();
+        if (!texture)
+            _cache.erase(it);
+        return texture;
+    }
+
+    Request::Request(std::shared_ptr<LoadState> state)
+        : m_state(std::move(state)), m_interest(m_state->interest.lock())
+    {
+        if (!m_interest)
+        {
+            m_interest = std::make_shared<char>();
+            m_state->interest = m_interest;
+        }
+    }
+
+    const std::string &Request::getPath() const
+    {
+        return m_state->path;
+    }
+
+    bool Request::isDone() const
+    {
+        return m_state->done;
+    }
+
+    bool Request::hasFailed() const
+    {
+        return m_state->done && !m_state->texture;
+    }
+
+    std::string Request::getError() const
+    {
+        return m_state->done ? m_state->error : std::string();
+    }
+
+    Texture Request::get() const
+    {
+        if (!m_state->done)
+        {
+            finish(*m_state);
+            removePending(*m_state);
+        }
+        if (!m_state->texture)
+            throw std::runtime_error(m_state->error);
+        return Texture(m_state->texture);
+    }
+
+    std::shared_ptr<SDL_Texture> acquire(const std::string &path)
+    {
+        if (path.empty())
+            throw std::invalid_argument("File path cannot be empty");
+
+        if (auto texture = findCached(path))
+            return texture;
+
+        if (auto state = findPending(path))
+        {
+            finish(*state);
+            removePending(*state);
+            if (!state->texture)
+                throw std::runtime_error(state->error);
+            return state->texture;
+        }
+
+        SDL_Surface *surface = SDL_LoadPNG(path.c_str());
+        if (!surface)
+            throw std::runtime_error("Failed to load image: " + std::string(SDL_GetError()));
+
+        SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer::_get(), surface);
+        SDL_DestroySurface(surface);
+
+        auto shared = Texture::share(texture);
+        _cache[path] = shared;
+        return shared;
+    }
+
+    Request loadAsync(const std::string &path)
+    {
+        if (path.empty())
+            throw std::invalid_argument("File path cannot be empty");
+
+        if (auto state = findPending(path))
+            return Request(state);
+
+        auto state = std::make_shared<LoadState>();
+        state->path = path;
+
+        // Already loaded: hand back a finished request
+        if (auto texture = findCached(path))
+        {
+            state->decoded = true;
+            state->done = true;
+            state->texture = std::move(texture);
+            return Request(state);
+        }
+
+        _pending.push_back(state);
+        jobs::submit([state]
+                     { decode(state); });
+        return Request(state);
+    }
+
+    void setUploadBudget(double milliseconds)
+    {
+        _uploadBudgetMs = std::max(0.0, milliseconds);
+    }
+
+    double getUploadBudget()
+    {
+        return _uploadBudgetMs;
+    }
+
+    size_t pendingCount()
+    {
+        return _pending.size();
+    }
+
+    size_t cachedCount()
+    {
+        size_t alive = 0;
+        for (const auto &[path, texture] : _cache)
+        {
+            if (!texture.expired())
+                alive++;
+        }
+        return alive;
+    }
+
+    void _pump()
+    {
+        if (_pending.empty())
+            return;
+
+        // Upload finished decodes in request order until the budget runs
+        // out; always at least one, so loading makes progress every frame
+        const Uint64 budgetNs = static_cast<Uint64>(_uploadBudgetMs * 1e6);
+        const Uint64 start = SDL_GetTicksNS();
+        bool uploaded = false;
+
+        for (auto it = _pending.begin(); it != _pending.end();)
+        {
+            const std::shared_ptr<LoadState> state = *it;
+            {
+                std::lock_guard lock(state->mutex);
+                if (!state->decoded)
+                {
+                    ++it;
+                    continue;
+                }
+            }
+
+            if (uploaded && SDL_GetTicksNS() - start >= budgetNs)
+                break;
+
+            // Nobody is waiting on this one any more; skip the upload
+            if (state->interest.expired())
+            {
+                SDL_DestroySurface(state->surface);
+                state->surface = nullptr;
+                state->done = true;
+            }
+            else
+            {
+                finish(*state);
+                uploaded = true;
+            }
+            it = _pending.erase(it);
+        }
+    }
+
+    void _quit()
+    {
+        // Workers have been joined, so every pending load is decoded
+        for (const auto &state : _pending)
+        {
+            if (state->surface)
+                SDL_DestroySurface(state->surface);
+            state->surface = nullptr;
+            state->done = true;
+        }
+        _pending.clear();
+        _cache.clear();
+    }
+}
@@ -0,0 +1,227 @@
+#include "TiledTexture.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "AssetPack.hpp"
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+TiledTexture::TiledTexture(AssetPack &pack, const std::string &name, int tileSize)
+{
+    const AssetPack::Image image = pack.getImage(name);
+    m_pixels = image.pixels;
+    m_pitch = image.pitch;
+    m_width = image.width;
+    m_height = image.height;
+    init(tileSize);
+}
+
+TiledTexture::TiledTexture(const std::string &pngPath, int tileSize)
+{
+    SDL_Surface *loaded = SDL_LoadPNG(pngPath.c_str());
+    if (!loaded)
+        throw std::runtime_error("Failed to load image: " + std::string(SDL_GetError()));
+
+    m_surface.reset(loaded->format == SDL_PIXELFORMAT_RGBA32 ? loaded : SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32));
+    if (m_surface.get() != loaded)
+        SDL_DestroySurface(loaded);
+    if (!m_surface)
+        throw std::runtime_error("Failed to convert image: " + std::string(SDL_GetError()));
+
+    m_pixels = static_cast<const uint8_t *>(m_surface->pixels);
+    m_pitch = m_surface->pitch;
+    m_width = m_surface->w;
+    m_height = m_surface->h;
+    init(tileSize);
+}
+
+TiledTexture::~TiledTexture() = default;
+
+void TiledTexture::init(int tileSize)
+{
+    if (tileSize <= 0)
+        throw std::invalid_argument("Tile size must be positive");
+
+    // Every tile, with its gutter, has to fit in one texture
+    const SDL_PropertiesID properties = SDL_GetRendererProperties(renderer::_get());
+    const Sint64 maxSize = SDL_GetNumberProperty(properties, SDL_PROP_RENDERER_MAX_TEXTURE_SIZE_NUMBER, 0);
+    if (maxSize > 0 && tileSize + 2 * GUTTER > maxSize)
+        throw std::invalid_argument("Tile size plus its gutter exceeds the renderer's texture size limit of " + std::to_string(maxSize));
+
+    m_tileSize = tileSize;
+    m_columns = (m_width + tileSize - 1) / tileSize;
+    m_rows = (m_height + tileSize - 1) / tileSize;
+    m_tiles.resize(static_cast<size_t>(m_columns) * m_rows);
+    m_generation = renderer::target_generation();
+}
+
+size_t TiledTexture::tileBytes(const SDL_Rect &rect)
+{
+    return static_cast<size_t>(rect.w + 2 * GUTTER) * (rect.h + 2 * GUTTER) * 4;
+}
+
+SDL_Rect TiledTexture::tileRect(size_t index) const
+{
+    const int x = static_cast<int>(index % m_columns) * m_tileSize;
+    const int y = static_cast<int>(index / m_columns) * m_tileSize;
+    return {x, y, std::min(m_tileSize, m_width - x), std::min(m_tileSize, m_height - y)};
+}
+
+Texture &TiledTexture::upload(size_t index)
+{
+    Tile &tile = m_tiles[index];
+    if (tile.texture)
+    {
+        m_lru.splice(m_lru.begin(), m_lru, tile.lru);
+        return *tile.texture;
+    }
+
+    const SDL_Rect rect = tileRect(index);
+    const int width = rect.w + 2 * GUTTER;
+    const int height = rect.h + 2 * GUTTER;
+    auto texture = Texture::share(SDL_CreateTexture(
+        renderer::_get(), SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC, width, height));
+
+    // The tile's rows plus a one-pixel border taken from the neighboring
+    // tiles, or repeated from the image edge; for a pack, only these pages
+    // are read
+    const int left = std::max(rect.x - 1, 0);
+    const int right = std::min(rect.x + rect.w, m_width - 1);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    m_staging.resize(rowBytes * height);
+    for (int row = 0; row < height; row++)
+    {
+        const int y = std::clamp(rect.y + row - GUTTER, 0, m_height - 1);
+        const uint8_t *src = m_pixels + static_cast<size_t>(y) * m_pitch;
+        uint8_t *dst = m_staging.data() + row * rowBytes;
+        std::memcpy(dst, src + static_cast<size_t>(left) * 4, 4);
+        std::memcpy(dst + 4, src + static_cast<size_t>(rect.x) * 4, static_cast<size_t>(rect.w) * 4);
+        std::memcpy(dst + rowBytes - 4, src + static_cast<size_t>(right) * 4, 4);
+    }
+    if (!SDL_UpdateTexture(texture.get(), nullptr, m_staging.data(), static_cast<int>(rowBytes)))
+        throw std::runtime_error("Failed to upload tile: " + std::string(SDL_GetError()));
+
+    tile.texture = std::make_unique<Texture>(std::move(texture), Rect(GUTTER, GUTTER, rect.w, rect.h));
+    m_lru.push_front(index);
+    tile.lru = m_lru.begin();
+    m_residentBytes += tileBytes(rect);
+    m_uploads++;
+    m_lastUploads++;
+    return *tile.texture;
+}
+
+void TiledTexture::evict(size_t index)
+{
+    Tile &tile = m_tiles[index];
+    if (!tile.texture)
+        return;
+
+    m_residentBytes -= tileBytes(tileRect(index));
+    m_lru.erase(tile.lru);
+    tile.texture.reset();
+}
+
+void TiledTexture::evictAll()
+{
+    while (!m_lru.empty())
+        evict(m_lru.back());
+}
+
+void TiledTexture::render()
+{
+    // Tile textures don't survive a device reset
+    if (m_generation != renderer::target_generation())
+    {
+        evictAll();
+        m_generation = renderer::target_generation();
+    }
+
+    m_frame++;
+    m_lastUploads = 0;
+    if (m_scale.x == 0.0 || m_scale.y == 0.0)
+        return;
+
+    // Tiles overlapping the image-space bounds of the view's corners, which
+    // also covers a rotated camera
+    int tileX0 = 0, tileY0 = 0;
+    int tileX1 = m_columns - 1, tileY1 = m_rows - 1;
+    if (renderer::get_culling())
+    {
+        const Vec2 size = renderer::get_view_size();
+        const Vec2 corners[4] = {
+            renderer::screen_to_world({0.0, 0.0}),
+            renderer::screen_to_world({size.x, 0.0}),
+            renderer::screen_to_world({0.0, size.y}),
+            renderer::screen_to_world({size.x, size.y}),
+        };
+        double minX = INFINITY, maxX = -INFINITY;
+        double minY = INFINITY, maxY = -INFINITY;
+        for (const Vec2 &corner : corners)
+        {
+            const double x = (corner.x - m_position.x) / m_scale.x;
+            const double y = (corner.y - m_position.y) / m_scale.y;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+        }
+
+        auto tileIndex = [&](double coord, int count)
+        {
+            return static_cast<int>(std::clamp(std::floor(coord / m_tileSize), -1.0, static_cast<double>(count)));
+        };
+        tileX0 = std::max(tileIndex(minX, m_columns), 0);
+        tileX1 = std::min(tileIndex(maxX, m_columns), m_columns - 1);
+        tileY0 = std::max(tileIndex(minY, m_rows), 0);
+        tileY1 = std::min(tileIndex(maxY, m_rows), m_rows - 1);
+    }
+
+    const double zero = 0.0;
+    for (int ty = tileY0; ty <= tileY1; ty++)
+    {
+        for (int tx = tileX0; tx <= tileX1; tx++)
+        {
+            const size_t index = static_cast<size_t>(ty) * m_columns + tx;
+            Texture &texture = upload(index);
+            m_tiles[index].lastDrawn = m_frame;
+            texture.setAlpha(m_alpha);
+
+            const SDL_Rect rect = tileRect(index);
+            const double x0 = m_position.x + rect.x * m_scale.x;
+            const double y0 = m_position.y + rect.y * m_scale.y;
+            const double x1 = m_position.x + (rect.x + rect.w) * m_scale.x;
+            const double y1 = m_position.y + (rect.y + rect.h) * m_scale.y;
+            const Vec2 corners[4] = {
+                renderer::world_to_screen({x0, y0}),
+                renderer::world_to_screen({x1, y0}),
+                renderer::world_to_screen({x1, y1}),
+                renderer::world_to_screen({x0, y1}),
+            };
+            // Sample inside the gutter
+            const float u0 = static_cast<float>(GUTTER) / (rect.w + 2 * GUTTER);
+            const float v0 = static_cast<float>(GUTTER) / (rect.h + 2 * GUTTER);
+            const float u1 = 1.0f - u0;
+            const float v1 = 1.0f - v0;
+            const float uv[4][2] = {{u0, v0}, {u1, v0}, {u1, v1}, {u0, v1}};
+
+            const SDL_FColor color = texture.getVertexColor();
+            SDL_Vertex vertices[4];
+            for (int k = 0; k < 4; k++)
+            {
+                vertices[k] = {{static_cast<float>(corners[k].x), static_cast<float>(corners[k].y)},
+                               color,
+                               {uv[k][0], uv[k][1]}};
+            }
+            if (renderer::draw_quads(texture, vertices, 1) == 0)
+                renderer::draw_batch_soa_rotated(texture, &x0, &y0, &zero, &m_scale.x, &m_scale.y, 1);
+        }
+    }
+
+    // Over budget: free the least recently drawn tiles, but never one this
+    // frame needs
+    while (m_residentBytes > m_budget && !m_lru.empty() && m_tiles[m_lru.back()].lastDrawn != m_frame)
+        evict(m_lru.back());
+}
@@ -0,0 +1,275 @@
+#include "Tilemap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "Jobs.hpp"
+#include "Texture.hpp"
+
+// Frames a chunk may stay off screen before its vertices are dropped
+constexpr uint64_t CHUNK_LIFETIME = 120;
+
+Tilemap::Tilemap(Texture *tileset, int columns, int rows, int tileWidth, int tileHeight, int chunkSize)
+    : m_tileset(tileset), m_columns(columns), m_rows(rows),
+      m_tileWidth(tileWidth), m_tileHeight(tileHeight), m_chunkSize(chunkSize)
+{
+    if (!m_tileset)
+        throw std::invalid_argument("Tilemap needs a tileset");
+    if (columns <= 0 || rows <= 0)
+        throw std::invalid_argument("Tilemap needs at least one column and one row");
+    if (tileWidth <= 0 || tileHeight <= 0)
+        throw std::invalid_argument("Tilemap tile size must be positive");
+    if (chunkSize <= 0)
+        throw std::invalid_argument("Tilemap chunk size must be positive");
+
+    m_chunkColumns = (columns + chunkSize - 1) / chunkSize;
+    m_chunkRows = (rows + chunkSize - 1) / chunkSize;
+    m_tiles.assign(static_cast<size_t>(columns) * rows, EMPTY);
+    m_chunks.resize(static_cast<size_t>(m_chunkColumns) * m_chunkRows);
+}
+
+int32_t Tilemap::getTile(int column, int row) const
+{
+    if (column < 0 || column >= m_columns || row < 0 || row >= m_rows)
+        throw std::out_of_range("Tilemap: tile out of range");
+    return m_tiles[static_cast<size_t>(row) * m_columns + column];
+}
+
+void Tilemap::setTile(int column, int row, int32_t id)
+{
+    if (column < 0 || column >= m_columns || row < 0 || row >= m_rows)
+        throw std::out_of_range("Tilemap: tile out of range");
+
+    int32_t &tile = m_tiles[static_cast<size_t>(row) * m_columns + column];
+    if (tile == id)
+        return;
+    tile = id;
+    m_chunks[static_cast<size_t>(row / m_chunkSize) * m_chunkColumns + column / m_chunkSize].dirty = true;
+}
+
+void Tilemap::setTiles(const int32_t *ids, size_t rows, size_t columns)
+{
+    if (rows != static_cast<size_t>(m_rows) || columns != static_cast<size_t>(m_columns))
+        throw std::invalid_argument("Tilemap: tile array shape must be (rows, columns)");
+
+    std::copy_n(ids, m_tiles.size(), m_tiles.begin());
+    markAllDirty();
+}
+
+void Tilemap::fill(int32_t id)
+{
+    std::fill(m_tiles.begin(), m_tiles.end(), id);
+    markAllDirty();
+}
+
+void Tilemap::markAllDirty()
+{
+    // Chunks without vertices are dirty already
+    for (size_t chunk : m_built)
+        m_chunks[chunk].dirty = true;
+}
+
+void Tilemap::buildChunk(size_t index)
+{
+    Chunk &chunk = m_chunks[index];
+    const int firstColumn = static_cast<int>(index % m_chunkColumns) * m_chunkSize;
+    const int firstRow = static_cast<int>(index / m_chunkColumns) * m_chunkSize;
+    const int lastColumn = std::min(firstColumn + m_chunkSize, m_columns);
+    const int lastRow = std::min(firstRow + m_chunkSize, m_rows);
+    const int32_t frameCount = static_cast<int32_t>(m_frames.count());
+    const float w = static_cast<float>(m_tileWidth);
+    const float h = static_cast<float>(m_tileHeight);
+
+    chunk.vertices.clear();
+    for (int row = firstRow; row < lastRow; row++)
+    {
+        const int32_t *ids = m_tiles.data() + static_cast<size_t>(row) * m_columns;
+        const float y = static_cast<float>(row) * h;
+        for (int column = firstColumn; column < lastColumn; column++)
+        {
+            const int32_t id = ids[column];
+            if (id < 0 || id >= frameCount)
+                continue;
+
+            const float x = static_cast<float>(column) * w;
+            const float *uv = m_frames.uv.data() + id * 4;
+            chunk.vertices.push_back({{x, y}, m_color, {uv[0], uv[1]}});
+            chunk.vertices.push_back({{x + w, y}, m_color, {uv[2], uv[1]}});
+            chunk.vertices.push_back({{x + w, y + h}, m_color, {uv[2], uv[3]}});
+            chunk.vertices.push_back({{x, y + h}, m_color, {uv[0], uv[3]}});
+        }
+    }
+    chunk.dirty = false;
+}
+
+void Tilemap::evictChunks()
+{
+    for (size_t i = 0; i < m_built.size();)
+    {
+        Chunk &chunk = m_chunks[m_built[i]];
+        if (chunk.lastDrawn + CHUNK_LIFETIME >= m_frame)
+        {
+            i++;
+            continue;
+        }
+
+        chunk.vertices = {};
+        chunk.built = false;
+        chunk.dirty = true;
+        m_built[i] = m_built.back();
+        m_built.pop_back();
+    }
+}
+
+void Tilemap::render()
+{
+    // Tileset changes invalidate every built chunk
+    renderer::frame_table(*m_tileset, m_scratchFrames);
+    const SDL_FColor color = m_tileset->getVertexColor();
+    if (!(m_scratchFrames == m_frames) || color.r != m_color.r || color.g != m_color.g ||
+        color.b != m_color.b || color.a != m_color.a)
+    {
+        std::swap(m_frames, m_scratchFrames);
+        m_color = color;
+        markAllDirty();
+    }
+
+    // Chunks overlapping the view: the map-space bounds of the view's
+    // corners, which also covers a rotated camera
+    int chunkX0 = 0, chunkY0 = 0;
+    int chunkX1 = m_chunkColumns - 1, chunkY1 = m_chunkRows - 1;
+    if (renderer::get_culling())
+    {
+        const Vec2 size = renderer::get_view_size();
+        const Vec2 corners[4] = {
+            renderer::screen_to_world({0.0, 0.0}),
+            renderer::screen_to_world({size.x, 0.0}),
+            renderer::screen_to_world({0.0, size.y}),
+            renderer::screen_to_world({size.x, size.y}),
+        };
+        double minX = corners[0].x, maxX = corners[0].x;
+        double minY = corners[0].y, maxY = corners[0].y;
+        for (const Vec2 &corner : corners)
+        {
+            minX = std::min(minX, corner.x);
+            maxX = std::max(maxX, corner.x);
+            minY = std::min(minY, corner.y);
+            maxY = std::max(maxY, corner.y);
+        }
+
+        const double chunkW = static_cast<double>(m_chunkSize) * m_tileWidth;
+        const double chunkH = static_cast<double>(m_chunkSize) * m_tileHeight;
+        auto chunkIndex = [](double coord, double extent, int count)
+        {
+            return static_cast<int>(std::clamp(std::floor(coord / extent), -1.0, static_cast<double>(count)));
+        };
+        chunkX0 = std::max(chunkIndex(minX - m_position.x, chunkW, m_chunkColumns), 0);
+        chunkX1 = std::min(chunkIndex(maxX - m_position.x, chunkW, m_chunkColumns), m_chunkColumns - 1);
+        chunkY0 = std::max(chunkIndex(minY - m_position.y, chunkH, m_chunkRows), 0);
+        chunkY1 = std::min(chunkIndex(maxY - m_position.y, chunkH, m_chunkRows), m_chunkRows - 1);
+    }
+
+    m_frame++;
+    m_visible.clear();
+    m_stale.clear();
+    for (int cy = chunkY0; cy <= chunkY1; cy++)
+    {
+        for (int cx = chunkX0; cx <= chunkX1; cx++)
+        {
+            const size_t index = static_cast<size_t>(cy) * m_chunkColumns + cx;
+            Chunk &chunk = m_chunks[index];
+            chunk.lastDrawn = m_frame;
+            if (!chunk.built)
+            {
+                chunk.built = true;
+                m_built.push_back(index);
+            }
+            if (chunk.dirty)
+                m_stale.push_back(index);
+            m_visible.push_back(index);
+        }
+    }
+
+    jobs::parallelFor(m_stale.size(), 1, [&](size_t begin, size_t end)
+                      {
+        for (size_t i = begin; i < end; i++)
+            buildChunk(m_stale[i]); });
+
+    m_offsets.resize(m_visible.size() + 1);
+    size_t total = 0;
+    for (size_t i = 0; i < m_visible.size(); i++)
+    {
+        m_offsets[i] = total;
+        total += m_chunks[m_visible[i]].vertices.size() / 4;
+    }
+    m_offsets[m_visible.size()] = total;
+
+    if (total > 0)
+    {
+        // Map space to world to render coordinates, through the camera
+        const renderer::QuadParams view = renderer::quad_params(*m_tileset, {}, {});
+        m_vertices.resize(total * 4);
+        jobs::parallelFor(m_visible.size(), 1, [&](size_t begin, size_t end)
+                          {
+            for (size_t i = begin; i < end; i++)
+            {
+                const std::vector<SDL_Vertex> &src = m_chunks[m_visible[i]].vertices;
+                SDL_Vertex *dst = m_vertices.data() + m_offsets[i] * 4;
+                for (size_t v = 0; v < src.size(); v++)
+                {
+                    const double x = src[v].position.x + m_position.x;
+                    const double y = src[v].position.y + m_position.y;
+                    dst[v].position.x = static_cast<float>(view.viewCos * x + view.viewSin * y + view.viewX);
+                    dst[v].position.y = static_cast<float>(-view.viewSin * x + view.viewCos * y + view.viewY);
+                    dst[v].color = src[v].color;
+                    dst[v].tex_coord = src[v].tex_coord;
+                }
+            } });
+
+        const size_t drawn = renderer::draw_quads(*m_tileset, m_vertices.data(), total);
+        if (drawn < total)
+        {
+            Texture tile = *m_tileset;
+            for (size_t i = 0; i < m_visible.size(); i++)
+            {
+                if (m_offsets[i + 1] > drawn)
+                    drawFallback(tile, m_visible[i], drawn > m_offsets[i] ? drawn - m_offsets[i] : 0);
+            }
+        }
+    }
+
+    evictChunks();
+}
+
+void Tilemap::drawFallback(Texture &tile, size_t index, size_t skip) const
+{
+    // Walk the chunk's tiles in build order, one rotated draw per tile
+    const int firstColumn = static_cast<int>(index % m_chunkColumns) * m_chunkSize;
+    const int firstRow = static_cast<int>(index / m_chunkColumns) * m_chunkSize;
+    const int lastColumn = std::min(firstColumn + m_chunkSize, m_columns);
+    const int lastRow = std::min(firstRow + m_chunkSize, m_rows);
+    const std::vector<Rect> &frames = m_tileset->getFrames();
+    const int32_t frameCount = static_cast<int32_t>(m_frames.count());
+    const double zero = 0.0;
+
+    size_t quad = 0;
+    for (int row = firstRow; row < lastRow; row++)
+    {
+        for (int column = firstColumn; column < lastColumn; column++)
+        {
+            const int32_t id = m_tiles[static_cast<size_t>(row) * m_columns + column];
+            if (id < 0 || id >= frameCount || quad++ < skip)
+                continue;
+
+            if (!frames.empty())
+                tile.setClipArea(frames[id]);
+            const Rect clip = tile.getClipArea();
+            const double x = m_position.x + static_cast<double>(column) * m_tileWidth;
+            const double y = m_position.y + static_cast<double>(row) * m_tileHeight;
+            const double scaleX = m_tileWidth / clip.w;
+            const double scaleY = m_tileHeight / clip.h;
+            renderer::draw_batch_soa_rotated(tile, &x, &y, &zero, &scaleX, &scaleY, 1);
+        }
+    }
+}
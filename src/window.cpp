@@ -1,6 +1,7 @@
 #include "Window.hpp"
 
 #include <SDL3/SDL.h>
+#include <cstring>
 #include <stdexcept>
 
 #include "Renderer.hpp"
@@ -10,18 +11,20 @@ namespace window
 {
     static SDL_Window *_window = nullptr;
     static bool _isOpen = false;
+    static bool _headless = false;
 
     void create(const std::string &title, const int width, const int height)
     {
         if (_window)
             throw std::runtime_error("Window already created");
 
-        _window = SDL_CreateWindow(title.c_str(), width, height, SDL_WINDOW_RESIZABLE);
+        const bool headless = isHeadless();
+        _window = SDL_CreateWindow(title.c_str(), width, height, headless ? SDL_WINDOW_HIDDEN : SDL_WINDOW_RESIZABLE);
         if (!_window)
             throw std::runtime_error(SDL_GetError());
 
         _isOpen = true;
-        renderer::_init(_window, width, height);
+        renderer::_init(_window, width, height, headless);
     }
 
     bool isOpen()
@@ -35,6 +38,27 @@ namespace window
         _isOpen = false;
     }
 
+    void setHeadless(bool enabled)
+    {
+        if (SDL_WasInit(SDL_INIT_VIDEO))
+            throw std::runtime_error("Headless mode must be chosen before init()");
+
+        _headless = enabled;
+        if (enabled)
+            SDL_SetHint(SDL_HINT_VIDEO_DRIVER, "offscreen,dummy");
+        else
+            SDL_ResetHint(SDL_HINT_VIDEO_DRIVER);
+    }
+
+    bool isHeadless()
+    {
+        if (_headless)
+            return true;
+
+        const char *driver = SDL_GetCurrentVideoDriver();
+        return driver && (std::strcmp(driver, "offscreen") == 0 || std::strcmp(driver, "dummy") == 0);
+    }
+
     void _quit()
     {
         if (_window)
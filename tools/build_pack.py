@@ -0,0 +1,36 @@
+"""Bundle every PNG and .ink script under a directory into a goob asset pack.
+
+    python tools/build_pack.py assets/ game.pack
+
+Entries are named by their path relative to the directory, e.g.
+"sprites/rifle.png", and are looked up by that name at runtime:
+
+    pack = goob.AssetPack("game.pack")
+    texture = pack.get_texture("sprites/rifle.png")
+"""
+
+import sys
+from pathlib import Path
+
+import goob
+
+
+def main() -> None:
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    root = Path(sys.argv[1])
+    out = Path(sys.argv[2])
+    files = sorted(
+        str(path)
+        for path in root.rglob("*")
+        if path.is_file() and path.suffix in (".png", ".ink")
+    )
+
+    goob.AssetPack.build(str(out), files, str(root))
+    print(f"packed {len(files)} assets into {out} ({out.stat().st_size} bytes)")
+
+
+if __name__ == "__main__":
+    main()